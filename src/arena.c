@@ -0,0 +1,180 @@
+#define _DEFAULT_SOURCE
+
+#include <sys/mman.h>
+
+#include "arena.h"
+
+struct ArenaChunk {
+    ArenaChunk* prev;
+    /// The number of bytes taken from the system, header included.
+    size_t size;
+    /// The number of bytes handed out, from the chunk start.
+    size_t used;
+    bool mapped;
+};
+
+static
+size_t align_up(size_t n, size_t align);
+static
+size_t chunk_header_size(void);
+
+static
+ArenaChunk* new_chunk(Arena* a, size_t needed);
+static
+void drop_chunk(ArenaChunk* c);
+static
+char* chunk_bump(ArenaChunk* c, size_t size);
+
+static
+void* arena_alloc(Allocator* al, size_t size);
+static
+void* arena_realloc(Allocator* al, void* ptr, size_t old_size, size_t new_size);
+static
+void arena_free(Allocator* al, void* ptr, size_t size);
+
+Arena Arena_new(size_t chunk_size, bool huge_pages) {
+    return (Arena) {
+        .allocator = {
+            .alloc = arena_alloc,
+            .realloc = arena_realloc,
+            .free = arena_free
+        },
+        .chunk = NULL,
+        .last = NULL,
+        .chunk_size = chunk_size,
+        .huge_pages = huge_pages
+    };
+}
+
+void Arena_drop(Arena* a) {
+    ArenaChunk* c = a->chunk;
+    while (c) {
+        ArenaChunk* prev = c->prev;
+        drop_chunk(c);
+        c = prev;
+    }
+    a->chunk = NULL;
+    a->last = NULL;
+}
+
+void Arena_reset(Arena* a) {
+    if (a->chunk) {
+        ArenaChunk* c = a->chunk->prev;
+        while (c) {
+            ArenaChunk* prev = c->prev;
+            drop_chunk(c);
+            c = prev;
+        }
+        a->chunk->prev = NULL;
+        a->chunk->used = chunk_header_size();
+    }
+    a->last = NULL;
+}
+
+Allocator* Arena_allocator(Arena* a) {
+    return &a->allocator;
+}
+
+size_t Arena_allocated(const Arena* a) {
+    size_t total = 0;
+    for (const ArenaChunk* c = a->chunk; c; c = c->prev) {
+        total += c->size;
+    }
+    return total;
+}
+
+size_t align_up(size_t n, size_t align) {
+    return (n + align - 1) / align * align;
+}
+
+size_t chunk_header_size() {
+    return align_up(sizeof(ArenaChunk), ARENA_ALIGN);
+}
+
+ArenaChunk* new_chunk(Arena* a, size_t needed) {
+    size_t size = size_t_max(a->chunk_size, chunk_header_size() + needed);
+    ArenaChunk* c;
+
+    if (a->huge_pages) {
+        size = align_up(size, ARENA_HUGE_PAGE_SIZE);
+        void* m = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m == MAP_FAILED) {
+            perror("cannot map arena chunk");
+            exit(1);
+        }
+#ifdef MADV_HUGEPAGE
+        // Only a hint: the chunk works the same without huge pages.
+        madvise(m, size, MADV_HUGEPAGE);
+#endif
+        c = m;
+    } else {
+        c = malloc(size);
+        assert_alloc(c);
+    }
+
+    *c = (ArenaChunk) {
+        .prev = a->chunk,
+        .size = size,
+        .used = chunk_header_size(),
+        .mapped = a->huge_pages
+    };
+    a->chunk = c;
+    return c;
+}
+
+void drop_chunk(ArenaChunk* c) {
+    if (c->mapped) {
+        munmap(c, c->size);
+    } else {
+        free(c);
+    }
+}
+
+char* chunk_bump(ArenaChunk* c, size_t size) {
+    size_t offset = align_up(c->used, ARENA_ALIGN);
+    if (offset > c->size || size > c->size - offset) {
+        return NULL;
+    }
+    c->used = offset + size;
+    return (char*)c + offset;
+}
+
+void* arena_alloc(Allocator* al, size_t size) {
+    Arena* a = (Arena*)al;
+    char* ptr = a->chunk ? chunk_bump(a->chunk, size) : NULL;
+    if (!ptr) {
+        ptr = chunk_bump(new_chunk(a, size), size);
+    }
+    a->last = ptr;
+    return ptr;
+}
+
+void* arena_realloc(Allocator* al, void* ptr, size_t old_size, size_t new_size) {
+    Arena* a = (Arena*)al;
+    if (!ptr) {
+        return arena_alloc(al, new_size);
+    }
+
+    if ((char*)ptr == a->last) {
+        // The last block grows or shrinks in place if its chunk has room.
+        size_t offset = a->last - (char*)a->chunk;
+        if (new_size <= a->chunk->size - offset) {
+            a->chunk->used = offset + new_size;
+            return ptr;
+        }
+    }
+
+    void* moved = arena_alloc(al, new_size);
+    memcpy(moved, ptr, size_t_min(old_size, new_size));
+    return moved;
+}
+
+void arena_free(Allocator* al, void* ptr, size_t size) {
+    (void) size;
+    Arena* a = (Arena*)al;
+    if (ptr && (char*)ptr == a->last) {
+        a->chunk->used = a->last - (char*)a->chunk;
+        a->last = NULL;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "core.h"
+
+/// A bump-pointer region allocator.
+
+/*
+ * ABOUT THE ARENA:
+ *
+ * Memory is taken from the system in chunks of at least `chunk_size` bytes
+ * and handed out by bumping a pointer, every block being aligned on
+ * `ARENA_ALIGN` bytes. Releasing a block does nothing, unless it is the last
+ * one handed out, and so does the reallocation of the last block as long as
+ * its chunk has room left. Everything is released at once by `Arena_drop`.
+ * An arena must not be used by several threads at the same time.
+ */
+
+#define ARENA_ALIGN 16
+#define ARENA_DEFAULT_CHUNK_SIZE ((size_t)1024*1024)
+#define ARENA_HUGE_PAGE_SIZE ((size_t)2*1024*1024)
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    /// Must stay the first member, the hooks cast it back to the arena.
+    Allocator allocator;
+    ArenaChunk* chunk;
+    /// The last block handed out, `NULL` if it was released.
+    char* last;
+    size_t chunk_size;
+    bool huge_pages;
+} Arena;
+
+/// Creates an empty arena taking chunks of at least `chunk_size` bytes.
+/// If `huge_pages` is set, the chunks are mapped on their own and rounded
+/// to `ARENA_HUGE_PAGE_SIZE`, and the system is asked to back them
+/// with huge pages when it can.
+/// No allocation is done at this call.
+Arena Arena_new(size_t chunk_size, bool huge_pages);
+
+/// Releases every block of the arena at once.
+void Arena_drop(Arena* a);
+
+/// Releases every block of the arena, keeping its current chunk for reuse.
+void Arena_reset(Arena* a);
+
+/// Returns the allocator of the arena, to be given to the containers.
+/// The arena must not be moved while containers are using it.
+Allocator* Arena_allocator(Arena* a);
+
+/// Returns the number of bytes taken from the system.
+size_t Arena_allocated(const Arena* a);
+
+#endif // ARENA_H
@@ -9,11 +9,13 @@ typedef enum {
 } Balance;
 
 static
-AVLNode* new_node(void* e, size_t elem_size);
+AVLNode* new_node(AVLTree* avl, void* e);
 static
-void may_drop_node(AVLNode* n);
+void drop_node(AVLTree* avl, AVLNode* n);
 static
-void may_drop_node_with(AVLNode* n, void (*drop_elem)(void*));
+void may_drop_node(AVLTree* avl, AVLNode* n);
+static
+void may_drop_node_with(AVLTree* avl, AVLNode* n, void (*drop_elem)(void*));
 
 static
 size_t height(const AVLNode* n);
@@ -39,43 +41,47 @@ static
 AVLNode* remove_max(AVLTree* avl, AVLNode* n, void* e);
 
 AVLTree AVLTree_new(size_t elem_size, int8_t (*compare)(const void*, const void*)) {
+    return AVLTree_new_in(elem_size, compare, NULL);
+}
+
+AVLTree AVLTree_new_in(size_t elem_size, int8_t (*compare)(const void*, const void*),
+                       Allocator* a) {
     return (AVLTree) {
         .root = NULL,
         .elem_size = elem_size,
-        .cmp = compare
+        .cmp = compare,
+        .allocator = a
     };
 }
 
 void AVLTree_clear(AVLTree* avl) {
-    may_drop_node(avl->root);
+    may_drop_node(avl, avl->root);
     avl->root = NULL;
 }
 
-void may_drop_node(AVLNode* n) {
+void may_drop_node(AVLTree* avl, AVLNode* n) {
     if (n) {
         AVLNode* l = n->left;
         AVLNode* r = n->right;
-        free(n->elem);
-        free(n);
-        may_drop_node(l);
-        may_drop_node(r);
+        drop_node(avl, n);
+        may_drop_node(avl, l);
+        may_drop_node(avl, r);
     }
 }
 
 void AVLTree_clear_with(AVLTree* avl, void (*drop_elem)(void*)) {
-    may_drop_node_with(avl->root, drop_elem);
+    may_drop_node_with(avl, avl->root, drop_elem);
     avl->root = NULL;
 }
 
-void may_drop_node_with(AVLNode* n, void (*drop_elem)(void*)) {
+void may_drop_node_with(AVLTree* avl, AVLNode* n, void (*drop_elem)(void*)) {
     if (n) {
         AVLNode* l = n->left;
         AVLNode* r = n->right;
         drop_elem((n)->elem);
-        free(n->elem);
-        free(n);
-        may_drop_node_with(l, drop_elem);
-        may_drop_node_with(r, drop_elem);
+        drop_node(avl, n);
+        may_drop_node_with(avl, l, drop_elem);
+        may_drop_node_with(avl, r, drop_elem);
     }
 }
 
@@ -87,17 +93,20 @@ bool AVLTree_is_empty(const AVLTree* avl) {
     return AVLTree_height(avl) == 0;
 }
 
-AVLNode* new_node(void* e, size_t elem_size) {
-    AVLNode* n = malloc(sizeof(AVLNode));
-    assert_alloc(n);
-    void* elem = malloc(elem_size); // we could avoid double allocation.
-    assert_alloc(elem);
-    memcpy(elem, e, elem_size);
+AVLNode* new_node(AVLTree* avl, void* e) {
+    AVLNode* n = Allocator_alloc(avl->allocator, sizeof(AVLNode));
+    void* elem = Allocator_alloc(avl->allocator, avl->elem_size); // we could avoid double allocation.
+    memcpy(elem, e, avl->elem_size);
 
     *n = (AVLNode) { .height = 1, .left = NULL, .right = NULL, .elem = elem };
     return n;
 }
 
+void drop_node(AVLTree* avl, AVLNode* n) {
+    Allocator_free(avl->allocator, n->elem, avl->elem_size);
+    Allocator_free(avl->allocator, n, sizeof(AVLNode));
+}
+
 size_t height(const AVLNode* n) {
     if (!n) return 0;
     return n->height;
@@ -171,7 +180,7 @@ bool AVLTree_insert(AVLTree* avl, void* e) {
 
 AVLNode* avl_insert(AVLTree* avl, AVLNode* n, void* e, bool* done) {
     if (!n) {
-        n = new_node(e, avl->elem_size);
+        n = new_node(avl, e);
         *done = true;
     } else {
         int8_t cmp = (*avl->cmp)(e, n->elem);
@@ -232,8 +241,7 @@ AVLNode* avl_remove(AVLTree* avl, AVLNode* n, const void* e, void* removed, bool
                     // thats what we want.
                     n = t->right;
                 }
-                free(t->elem);
-                free(t);
+                drop_node(avl, t);
             }
 
             if (n) { // might be done better.
@@ -262,8 +270,7 @@ AVLNode* remove_max(AVLTree* avl, AVLNode* n, void* e) {
         // if there is no left then `n` will be `NULL`,
         // thats what we want because we already know that there is no right.
         n = t->left;
-        free(t->elem);
-        free(t);
+        drop_node(avl, t);
 
         if (n) { // might be done better.
             update_height(n);
@@ -20,12 +20,18 @@ typedef struct {
     AVLNode* root;
     const size_t elem_size;
     int8_t (*cmp)(const void*, const void*);
+    /// Where the nodes are allocated, `NULL` for the heap.
+    Allocator* allocator;
 } AVLTree;
 
 /// Creates an empty tree that will be ordered by `compare`.
 /// No allocation is done at this call.
 AVLTree AVLTree_new(size_t elem_size, int8_t (*compare)(const void*, const void*));
 
+/// Creates an empty tree like `AVLTree_new`, allocating the nodes with `a`.
+AVLTree AVLTree_new_in(size_t elem_size, int8_t (*compare)(const void*, const void*),
+                       Allocator* a);
+
 /// Clears the tree, removing all elements.
 void AVLTree_clear(AVLTree* avl);
 
@@ -0,0 +1,22 @@
+#include "util.h"
+#include "netlist.h"
+#include "netlist_binary.h"
+
+/// Converts a binary or compressed netlist back to the text format.
+
+int main() {
+    char input[255];
+    ask_str("enter the binary or compressed netlist path: ", input, 255);
+    char output[255];
+    ask_str("enter the text netlist path: ", output, 255);
+
+    printf("converting `%s` ... ", input);
+
+    Netlist netlist = Netlist_from_file(input);
+    Netlist_to_file(&netlist, output);
+    Netlist_drop(&netlist);
+
+    printf(TERM_GREEN("✓")"\n");
+
+    return EXIT_SUCCESS;
+}
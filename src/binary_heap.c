@@ -23,8 +23,13 @@ static
 size_t heap_get_mut_lower_child(BinaryHeap* bh, size_t i, void** e);
 
 BinaryHeap BinaryHeap_new(size_t elem_size, bool (*strict_order)(const void*, const void*)) {
+    return BinaryHeap_new_in(elem_size, strict_order, NULL);
+}
+
+BinaryHeap BinaryHeap_new_in(size_t elem_size, bool (*strict_order)(const void*, const void*),
+                             Allocator* a) {
     return (BinaryHeap) {
-        .vec = Vec_new(elem_size),
+        .vec = Vec_new_in(elem_size, a),
         .strict_order = strict_order
     };
 }
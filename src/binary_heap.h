@@ -18,6 +18,10 @@ typedef struct {
 /// No allocation is done at this call.
 BinaryHeap BinaryHeap_new(size_t elem_size, bool (*strict_order)(const void*, const void*));
 
+/// Creates an empty heap like `BinaryHeap_new`, allocating with `a`.
+BinaryHeap BinaryHeap_new_in(size_t elem_size, bool (*strict_order)(const void*, const void*),
+                             Allocator* a);
+
 /// Releases the heap resources.
 void BinaryHeap_drop(BinaryHeap* bh);
 
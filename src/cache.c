@@ -0,0 +1,190 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "cache.h"
+#include "mapped_file.h"
+#include "vec.h"
+
+#define FNV_OFFSET_BASIS UINT64_C(14695981039346656037)
+#define FNV_PRIME UINT64_C(1099511628211)
+
+typedef struct {
+    char* path;
+    size_t size;
+    struct timespec mtime;
+} CacheEntry;
+
+static
+char* entry_path(const Cache* c, CacheKey key, const char* kind, const char* suffix);
+static
+void evict(Cache* c);
+static
+int entry_order(const void* a, const void* b);
+
+Cache Cache_open(const char* dir, size_t max_size) {
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        perror("cannot create cache directory");
+        exit(1);
+    }
+
+    size_t dir_len = strlen(dir);
+    char* d = malloc(dir_len + 1);
+    assert_alloc(d);
+    memcpy(d, dir, dir_len + 1);
+
+    return (Cache) {
+        .dir = d,
+        .max_size = max_size,
+        .hits = 0,
+        .misses = 0,
+        .evictions = 0
+    };
+}
+
+void Cache_drop(Cache* c) {
+    free(c->dir);
+}
+
+CacheKey CacheKey_new() {
+    return FNV_OFFSET_BASIS;
+}
+
+CacheKey CacheKey_add_bytes(CacheKey k, const void* data, size_t len) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        k ^= bytes[i];
+        k *= FNV_PRIME;
+    }
+    return k;
+}
+
+CacheKey CacheKey_add_str(CacheKey k, const char* s) {
+    return CacheKey_add_bytes(k, s, strlen(s) + 1);
+}
+
+CacheKey CacheKey_add_file(CacheKey k, const char* path) {
+    MappedFile mf = MappedFile_open(path);
+    k = CacheKey_add_bytes(k, mf.data, mf.len);
+    // The length separates the file from what is hashed after it.
+    uint64_t len = mf.len;
+    k = CacheKey_add_bytes(k, &len, sizeof(len));
+    MappedFile_drop(&mf);
+    return k;
+}
+
+char* entry_path(const Cache* c, CacheKey key, const char* kind, const char* suffix) {
+    int len = snprintf(NULL, 0, "%s/%016llx.%s%s", c->dir, (unsigned long long)key, kind, suffix);
+    char* path = malloc((size_t)len + 1);
+    assert_alloc(path);
+    snprintf(path, (size_t)len + 1, "%s/%016llx.%s%s", c->dir, (unsigned long long)key, kind, suffix);
+    return path;
+}
+
+char* Cache_get(Cache* c, CacheKey key, const char* kind) {
+    char* path = entry_path(c, key, kind, "");
+
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        c->misses++;
+        free(path);
+        return NULL;
+    }
+
+    // Marks the entry as recently used, failing only costs an early eviction.
+    utimensat(AT_FDCWD, path, NULL, 0);
+    c->hits++;
+    return path;
+}
+
+void Cache_put(Cache* c, CacheKey key, const char* kind,
+               void (*save)(const void*, const char*), const void* data) {
+    char* tmp_path = entry_path(c, key, kind, ".tmp");
+    char* path = entry_path(c, key, kind, "");
+
+    save(data, tmp_path);
+    if (rename(tmp_path, path) != 0) {
+        perror("cannot create cache entry");
+        exit(1);
+    }
+
+    free(path);
+    free(tmp_path);
+
+    evict(c);
+}
+
+void evict(Cache* c) {
+    DIR* d = opendir(c->dir);
+    if (!d) {
+        perror("cannot read cache directory");
+        exit(1);
+    }
+
+    Vec entries = Vec_new(sizeof(CacheEntry));
+    size_t total_size = 0;
+    size_t dir_len = strlen(c->dir);
+
+    struct dirent* e;
+    while ((e = readdir(d))) {
+        if (e->d_name[0] == '.') continue;
+
+        size_t name_len = strlen(e->d_name);
+        char* path = malloc(dir_len + 1 + name_len + 1);
+        assert_alloc(path);
+        memcpy(path, c->dir, dir_len);
+        path[dir_len] = '/';
+        memcpy(path + dir_len + 1, e->d_name, name_len + 1);
+
+        struct stat st;
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            free(path);
+            continue;
+        }
+
+        CacheEntry entry = { .path = path, .size = (size_t)st.st_size, .mtime = st.st_mtim };
+        Vec_push(&entries, &entry);
+        total_size += entry.size;
+    }
+    closedir(d);
+
+    if (total_size > c->max_size) {
+        qsort(entries.data, Vec_len(&entries), sizeof(CacheEntry), entry_order);
+
+        size_t entry_count = Vec_len(&entries);
+        for (size_t i = 0; i < entry_count && total_size > c->max_size; i++) {
+            const CacheEntry* entry = Vec_get(&entries, i);
+            if (remove(entry->path) == 0) {
+                total_size -= entry->size;
+                c->evictions++;
+            }
+        }
+    }
+
+    CacheEntry entry;
+    while (Vec_pop(&entries, &entry)) {
+        free(entry.path);
+    }
+    Vec_drop(&entries);
+}
+
+int entry_order(const void* a, const void* b) {
+    const CacheEntry* ea = a;
+    const CacheEntry* eb = b;
+
+    if (ea->mtime.tv_sec != eb->mtime.tv_sec) {
+        return (ea->mtime.tv_sec < eb->mtime.tv_sec) ? -1 : 1;
+    } else if (ea->mtime.tv_nsec != eb->mtime.tv_nsec) {
+        return (ea->mtime.tv_nsec < eb->mtime.tv_nsec) ? -1 : 1;
+    }
+    return 0;
+}
+
+void Cache_print_stats(const Cache* c) {
+    printf("cache: %zu hits, %zu misses, %zu evictions\n",
+           c->hits, c->misses, c->evictions);
+}
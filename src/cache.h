@@ -0,0 +1,67 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "core.h"
+
+/// An on-disk cache for computation results, keyed by a hash of their inputs.
+
+/*
+ * ABOUT THE CACHE:
+ *
+ * Every entry is a file of the cache directory named `<key>.<kind>`,
+ * the key being written in hexadecimal, e.g. `00c0ffee00c0ffee.int`.
+ * Keys are FNV-1a hashes of everything the result depends on: the contents
+ * of the input files and the name of the engine or solver. Hence an entry is
+ * reused exactly when its inputs are unchanged, whatever their paths.
+ * Reading an entry updates its modification time and when the entries take
+ * more than the size bound, the least recently used ones are removed.
+ */
+
+#define CACHE_DEFAULT_DIR "cache"
+#define CACHE_DEFAULT_MAX_SIZE ((size_t)256*1024*1024)
+
+typedef struct {
+    char* dir;
+    size_t max_size;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} Cache;
+
+typedef uint64_t CacheKey;
+
+/// Opens the cache stored in `dir`, creating the directory if needed.
+/// The entries will take at most `max_size` bytes.
+Cache Cache_open(const char* dir, size_t max_size);
+
+/// Releases the cache resources, the entries stay on disk.
+void Cache_drop(Cache* c);
+
+/// Returns the key of an empty input.
+CacheKey CacheKey_new(void);
+
+/// Adds `len` bytes to the hashed input.
+CacheKey CacheKey_add_bytes(CacheKey k, const void* data, size_t len);
+
+/// Adds a string to the hashed input, its terminating '\0' included
+/// so that `"ab", "c"` and `"a", "bc"` give different keys.
+CacheKey CacheKey_add_str(CacheKey k, const char* s);
+
+/// Adds the contents of a file to the hashed input.
+CacheKey CacheKey_add_file(CacheKey k, const char* path);
+
+/// Returns the path of the entry if it is cached, `NULL` otherwise.
+/// The path has to be freed by the caller.
+char* Cache_get(Cache* c, CacheKey key, const char* kind);
+
+/// Creates an entry by calling `save(data, path)`, then evicts
+/// the least recently used entries if the cache got too large.
+/// The entry is written to a temporary file first, so that other processes
+/// never see it partially written.
+void Cache_put(Cache* c, CacheKey key, const char* kind,
+               void (*save)(const void*, const char*), const void* data);
+
+/// Prints the hit, miss and eviction counts on the terminal.
+void Cache_print_stats(const Cache* c);
+
+#endif // CACHE_H
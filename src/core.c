@@ -18,6 +18,26 @@ void assert_alloc(void* ptr) {
     }
 }
 
+void* Allocator_alloc(Allocator* a, size_t size) {
+    void* ptr = a ? a->alloc(a, size) : malloc(size);
+    assert_alloc(ptr);
+    return ptr;
+}
+
+void* Allocator_realloc(Allocator* a, void* ptr, size_t old_size, size_t new_size) {
+    ptr = a ? a->realloc(a, ptr, old_size, new_size) : realloc(ptr, new_size);
+    assert_alloc(ptr);
+    return ptr;
+}
+
+void Allocator_free(Allocator* a, void* ptr, size_t size) {
+    if (a) {
+        a->free(a, ptr, size);
+    } else {
+        free(ptr);
+    }
+}
+
 bool is_power_of_two(size_t n) {
     // bits.stephan-brumme.com
     return ((n & (n - 1)) == 0) && (n != 0);
@@ -21,6 +21,28 @@ void mem_swap_with(void* a, void* b, void* t, size_t n);
 /// Fires an error if `ptr` is `NULL`.
 void assert_alloc(void* ptr);
 
+/// Allocation hooks, so that containers can take their memory elsewhere than
+/// from `malloc`. The sizes of the blocks are given back on reallocation
+/// and release, so that hooks do not have to remember them.
+/// Containers given a `NULL` allocator use `malloc`, `realloc` and `free`.
+typedef struct Allocator Allocator;
+struct Allocator {
+    void* (*alloc)(Allocator* a, size_t size);
+    void* (*realloc)(Allocator* a, void* ptr, size_t old_size, size_t new_size);
+    void (*free)(Allocator* a, void* ptr, size_t size);
+};
+
+/// Allocates `size` bytes with `a`.
+/// Fires an error if the allocation fails.
+void* Allocator_alloc(Allocator* a, size_t size);
+
+/// Resizes the block `ptr` of `old_size` bytes allocated with `a`.
+/// Fires an error if the allocation fails.
+void* Allocator_realloc(Allocator* a, void* ptr, size_t old_size, size_t new_size);
+
+/// Releases the block `ptr` of `size` bytes allocated with `a`.
+void Allocator_free(Allocator* a, void* ptr, size_t size);
+
 /// Is `n` a power of two ?
 bool is_power_of_two(size_t n);
 
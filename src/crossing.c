@@ -0,0 +1,134 @@
+#include "crossing.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CROSSING_AVX2
+#include <immintrin.h>
+#endif
+
+static
+size_t find_scalar(const CrossingSet* cs, size_t first, int32_t x, int32_t y0, int32_t y1,
+                   uint32_t net, Vec* ids);
+
+#ifdef CROSSING_AVX2
+static
+size_t find_avx2(const CrossingSet* cs, size_t first, int32_t x, int32_t y0, int32_t y1,
+                 uint32_t net, Vec* ids);
+#endif
+
+CrossingSet CrossingSet_new() {
+    return (CrossingSet) {
+        .ys = Vec_new(sizeof(int32_t)),
+        .x0s = Vec_new(sizeof(int32_t)),
+        .x1s = Vec_new(sizeof(int32_t)),
+        .nets = Vec_new(sizeof(uint32_t)),
+        .ids = Vec_new(sizeof(size_t))
+    };
+}
+
+void CrossingSet_drop(CrossingSet* cs) {
+    Vec_drop(&cs->ys);
+    Vec_drop(&cs->x0s);
+    Vec_drop(&cs->x1s);
+    Vec_drop(&cs->nets);
+    Vec_drop(&cs->ids);
+}
+
+size_t CrossingSet_len(const CrossingSet* cs) {
+    return Vec_len(&cs->ids);
+}
+
+void CrossingSet_push(CrossingSet* cs, int32_t y, int32_t x0, int32_t x1,
+                      uint32_t net, size_t id) {
+    Vec_push(&cs->ys, &y);
+    Vec_push(&cs->x0s, &x0);
+    Vec_push(&cs->x1s, &x1);
+    Vec_push(&cs->nets, &net);
+    Vec_push(&cs->ids, &id);
+}
+
+bool CrossingSet_remove(CrossingSet* cs, size_t id) {
+    size_t len = CrossingSet_len(cs);
+    const size_t* ids = cs->ids.data;
+    for (size_t i = 0; i < len; i++) {
+        if (ids[i] == id) {
+            Vec_swap_remove(&cs->ys, i, NULL);
+            Vec_swap_remove(&cs->x0s, i, NULL);
+            Vec_swap_remove(&cs->x1s, i, NULL);
+            Vec_swap_remove(&cs->nets, i, NULL);
+            Vec_swap_remove(&cs->ids, i, NULL);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CrossingSet_find(const CrossingSet* cs, int32_t x, int32_t y0, int32_t y1,
+                      uint32_t net, Vec* ids) {
+    CrossingSet_find_from(cs, 0, x, y0, y1, net, ids);
+}
+
+void CrossingSet_find_from(const CrossingSet* cs, size_t first, int32_t x, int32_t y0, int32_t y1,
+                           uint32_t net, Vec* ids) {
+#ifdef CROSSING_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        first = find_avx2(cs, first, x, y0, y1, net, ids);
+    }
+#endif
+    find_scalar(cs, first, x, y0, y1, net, ids);
+}
+
+size_t find_scalar(const CrossingSet* cs, size_t first, int32_t x, int32_t y0, int32_t y1,
+                   uint32_t net, Vec* ids) {
+    size_t len = CrossingSet_len(cs);
+    const int32_t* ys = cs->ys.data;
+    const int32_t* x0s = cs->x0s.data;
+    const int32_t* x1s = cs->x1s.data;
+    const uint32_t* nets = cs->nets.data;
+    const size_t* all_ids = cs->ids.data;
+    for (size_t i = first; i < len; i++) {
+        if (nets[i] != net && x0s[i] <= x && x <= x1s[i] && y0 <= ys[i] && ys[i] <= y1) {
+            size_t id = all_ids[i];
+            Vec_push(ids, &id);
+        }
+    }
+    return len;
+}
+
+#ifdef CROSSING_AVX2
+__attribute__((target("avx2")))
+size_t find_avx2(const CrossingSet* cs, size_t first, int32_t x, int32_t y0, int32_t y1,
+                 uint32_t net, Vec* ids) {
+    size_t len = CrossingSet_len(cs);
+    const int32_t* ys = cs->ys.data;
+    const int32_t* x0s = cs->x0s.data;
+    const int32_t* x1s = cs->x1s.data;
+    const uint32_t* nets = cs->nets.data;
+    const size_t* all_ids = cs->ids.data;
+
+    __m256i vx = _mm256_set1_epi32(x);
+    __m256i vy0 = _mm256_set1_epi32(y0);
+    __m256i vy1 = _mm256_set1_epi32(y1);
+    __m256i vnet = _mm256_set1_epi32((int32_t)net);
+    size_t i = first;
+    for (; i + CROSSING_BLOCK <= len; i += CROSSING_BLOCK) {
+        __m256i y = _mm256_loadu_si256((const __m256i*)&ys[i]);
+        __m256i x0 = _mm256_loadu_si256((const __m256i*)&x0s[i]);
+        __m256i x1 = _mm256_loadu_si256((const __m256i*)&x1s[i]);
+        __m256i n = _mm256_loadu_si256((const __m256i*)&nets[i]);
+
+        // The lanes failing any of the tests are set.
+        __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(x0, vx), _mm256_cmpgt_epi32(vx, x1));
+        out = _mm256_or_si256(out, _mm256_cmpgt_epi32(vy0, y));
+        out = _mm256_or_si256(out, _mm256_cmpgt_epi32(y, vy1));
+        out = _mm256_or_si256(out, _mm256_cmpeq_epi32(n, vnet));
+
+        uint32_t mask = ~(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xff;
+        while (mask) {
+            size_t id = all_ids[i + (size_t)__builtin_ctz(mask)];
+            Vec_push(ids, &id);
+            mask &= mask - 1;
+        }
+    }
+    return i;
+}
+#endif
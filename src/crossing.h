@@ -0,0 +1,60 @@
+#ifndef CROSSING_H
+#define CROSSING_H
+
+#include "vec.h"
+
+/// Crossing tests of a vertical segment against many horizontal ones.
+
+/*
+ * ABOUT THE CROSSING SET:
+ *
+ * The horizontal segments are stored field by field, so that a vertical
+ * segment is tested against blocks of `CROSSING_BLOCK` of them at once:
+ * each field of the block is compared in one AVX2 instruction, giving a
+ * mask of the crossing segments which is then compacted into their ids.
+ * The processors without AVX2, and the segments left after the last
+ * block, are tested one at a time.
+ * A horizontal segment crosses a vertical one if it belongs to another net,
+ * `x0 <= x <= x1` and `y0 <= y <= y1`, the ends included.
+ */
+
+#define CROSSING_BLOCK 8
+
+typedef struct {
+    Vec ys;
+    Vec x0s;
+    Vec x1s;
+    Vec nets;
+    /// An id chosen by the caller for every segment.
+    Vec ids;
+} CrossingSet;
+
+/// Creates an empty set.
+/// No allocation is done at this call.
+CrossingSet CrossingSet_new(void);
+
+/// Releases the set resources.
+void CrossingSet_drop(CrossingSet* cs);
+
+/// Returns the number of segments in the set.
+size_t CrossingSet_len(const CrossingSet* cs);
+
+/// Pushes the horizontal segment of the net `net` at `y` from `x0` to `x1`.
+void CrossingSet_push(CrossingSet* cs, int32_t y, int32_t x0, int32_t x1,
+                      uint32_t net, size_t id);
+
+/// Removes the segment pushed with `id`, the last segment takes its place.
+/// Returns `false` if there is no such segment.
+bool CrossingSet_remove(CrossingSet* cs, size_t id);
+
+/// Pushes in `ids` the id of every segment of the set crossing the vertical segment
+/// of the net `net` at `x` from `y0` to `y1`, in the set order.
+void CrossingSet_find(const CrossingSet* cs, int32_t x, int32_t y0, int32_t y1,
+                      uint32_t net, Vec* ids);
+
+/// Like `CrossingSet_find`, testing only the segments from the `first`-th on, in push order.
+/// Nothing is removed while the set is read, so several threads can search it at once.
+void CrossingSet_find_from(const CrossingSet* cs, size_t first, int32_t x, int32_t y0, int32_t y1,
+                           uint32_t net, Vec* ids);
+
+#endif // CROSSING_H
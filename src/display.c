@@ -218,10 +218,10 @@ void Graph_to_ps(const Graph* g, const Netlist* nl, const char* path) {
             const GraphNode* node = Vec_get(&g->nodes, i);
             ps_draw_point(f, *node->point, &trans);
 
-            size_t continuity_count = Vec_len(&node->continuity);
+            size_t continuity_count = GraphAdjacency_degree(&g->continuity, i);
+            const index_t* neighbours = GraphAdjacency_neighbours(&g->continuity, i);
             for (size_t c = 0; c < continuity_count; c++) {
-                const GraphEdge* edge = Vec_get(&node->continuity, c);
-                const GraphNode* continuity = Vec_get(&g->nodes, edge->v);
+                const GraphNode* continuity = Vec_get(&g->nodes, neighbours[c]);
                 const Point* c_beg = Vec_get(&net->points, continuity->segment->beg);
                 const Point* c_end = Vec_get(&net->points, continuity->segment->end);
                 ps_draw_line(f, *node->point, middle_of(c_beg, c_end), &trans);
@@ -254,13 +254,13 @@ void Graph_to_ps(const Graph* g, const Netlist* nl, const char* path) {
             const Point* end = Vec_get(&net->points, node->segment->end);
             Point mid = middle_of(beg, end);
 
-            size_t conflict_count = Vec_len(&node->conflict);
+            size_t conflict_count = GraphAdjacency_degree(&g->conflict, i);
+            const index_t* neighbours = GraphAdjacency_neighbours(&g->conflict, i);
             for (size_t c = 0; c < conflict_count; c++) {
-                const GraphEdge* edge = Vec_get(&node->conflict, c);
-                const GraphNode* conflict = Vec_get(&g->nodes, edge->v);
+                const GraphNode* conflict = Vec_get(&g->nodes, neighbours[c]);
                 size_t c_n = 0;
                 for (size_t j = 0; j < net_count; j++) {
-                    if (edge->v > *(const size_t*)Vec_get(&g->net_offsets, j)) {
+                    if (neighbours[c] > *(const size_t*)Vec_get(&g->net_offsets, j)) {
                         c_n = j;
                     } else {
                         break;
@@ -307,13 +307,13 @@ void Solution_to_ps(const BitSet* sol, const Graph* g,
             const GraphNode* node = Vec_get(&g->nodes, i);
             ps_draw_point(f, *node->point, &trans);
 
-            size_t continuity_count = Vec_len(&node->continuity);
+            size_t continuity_count = GraphAdjacency_degree(&g->continuity, i);
+            const index_t* neighbours = GraphAdjacency_neighbours(&g->continuity, i);
             for (size_t c = 0; c < continuity_count; c++) {
-                const GraphEdge* edge = Vec_get(&node->continuity, c);
-                const GraphNode* continuity = Vec_get(&g->nodes, edge->v);
+                const GraphNode* continuity = Vec_get(&g->nodes, neighbours[c]);
                 const Point* c_beg = Vec_get(&net->points, continuity->segment->beg);
                 const Point* c_end = Vec_get(&net->points, continuity->segment->end);
-                if (BitSet_contains(sol, edge->v)) {
+                if (BitSet_contains(sol, neighbours[c])) {
                     ps_draw_hidden_line(f, *node->point, middle_of(c_beg, c_end),
                                         &trans);
                 } else {
@@ -0,0 +1,275 @@
+#include "util.h"
+#include "hierarchy.h"
+
+typedef struct {
+    size_t instance;
+    AABB aabb;
+} InstanceBox;
+
+#define SYNTAX_ERROR(desc) {                            \
+    perror("hierarchy file syntax error: "desc"\n");    \
+    exit(1);                                            \
+}
+
+static
+char* block_path(const char* hierarchy_path, const char* path);
+static
+void block_drop(Block* b);
+static
+AABB translated_aabb(AABB aabb, Vector offset);
+static
+Net translated_net(const Net* net, Vector offset);
+static
+const IntersectionVec* block_intersections(Block* b);
+static
+int box_order(const void* a, const void* b);
+static
+void add_crossings(IntersectionVec* intersections, const Hierarchy* h,
+                   const InstanceBox* a, const InstanceBox* b);
+
+Hierarchy Hierarchy_from_file(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror("cannot read hierarchy input file");
+        exit(1);
+    }
+
+    char line[255];
+    size_t block_count;
+    if (!fgets(line, 255, f) || sscanf(line, "%zu", &block_count) != 1) {
+        SYNTAX_ERROR("expected block count on first line");
+    }
+
+    Vec blocks = Vec_with_capacity(block_count, sizeof(Block));
+    for (size_t b = 0; b < block_count; b++) {
+        char name[255];
+        if (!fgets(line, 255, f) || sscanf(line, "%*u %254s", name) != 1) {
+            SYNTAX_ERROR("expected `block_number block_path` block description");
+        }
+        char* netlist_path = block_path(path, name);
+        Block block = {
+            .netlist = Netlist_from_file(netlist_path),
+            .has_intersections = false
+        };
+        free(netlist_path);
+        Vec_push(&blocks, &block);
+    }
+
+    size_t instance_count;
+    if (!fgets(line, 255, f) || sscanf(line, "%zu", &instance_count) != 1) {
+        SYNTAX_ERROR("expected instance count after the blocks");
+    }
+
+    Vec instances = Vec_with_capacity(instance_count, sizeof(Instance));
+    size_t net_count = 0;
+    AABB aabb = { { 0, 0 }, { 0, 0 } };
+    for (size_t i = 0; i < instance_count; i++) {
+        Instance instance = { .first_net = net_count };
+        if (!fgets(line, 255, f) ||
+            sscanf(line, "%*u %zu %d %d", &instance.block,
+                   &instance.offset.x, &instance.offset.y) != 3 ||
+            instance.block >= block_count) {
+            SYNTAX_ERROR("expected `instance_number block_number offset_x offset_y` instance description");
+        }
+        Vec_push(&instances, &instance);
+
+        const Block* block = Vec_get(&blocks, instance.block);
+        net_count += Vec_len(&block->netlist.nets);
+        if (!index_fits(net_count)) {
+            SYNTAX_ERROR("too many nets for the index size");
+        }
+
+        AABB instance_aabb = translated_aabb(block->netlist.aabb, instance.offset);
+        if (i == 0) {
+            aabb = instance_aabb;
+        } else {
+            aabb.inf.x = int32_t_min(aabb.inf.x, instance_aabb.inf.x);
+            aabb.inf.y = int32_t_min(aabb.inf.y, instance_aabb.inf.y);
+            aabb.sup.x = int32_t_max(aabb.sup.x, instance_aabb.sup.x);
+            aabb.sup.y = int32_t_max(aabb.sup.y, instance_aabb.sup.y);
+        }
+    }
+
+    fclose(f);
+
+    return (Hierarchy) {
+        .blocks = blocks,
+        .instances = instances,
+        .net_count = net_count,
+        .aabb = aabb
+    };
+}
+
+char* block_path(const char* hierarchy_path, const char* path) {
+    const char* dir_end = strrchr(hierarchy_path, '/');
+    if (path[0] == '/' || !dir_end) {
+        return str_clone(path);
+    }
+
+    size_t dir_len = (size_t)(dir_end - hierarchy_path) + 1;
+    size_t path_len = strlen(path);
+    char* res = malloc(dir_len + path_len + 1);
+    assert_alloc(res);
+    memcpy(res, hierarchy_path, dir_len);
+    memcpy(res + dir_len, path, path_len + 1);
+    return res;
+}
+
+void Hierarchy_drop(Hierarchy* h) {
+    Vec_drop_with(&h->blocks, (void (*)(void*))block_drop);
+    Vec_drop(&h->instances);
+}
+
+void block_drop(Block* b) {
+    Netlist_drop(&b->netlist);
+    if (b->has_intersections) {
+        Vec_drop(&b->intersections);
+    }
+}
+
+AABB translated_aabb(AABB aabb, Vector offset) {
+    return (AABB) {
+        .inf = { aabb.inf.x + offset.x, aabb.inf.y + offset.y },
+        .sup = { aabb.sup.x + offset.x, aabb.sup.y + offset.y }
+    };
+}
+
+Netlist Hierarchy_flatten(const Hierarchy* h) {
+    Vec nets = Vec_with_capacity(h->net_count, sizeof(Net));
+
+    size_t instance_count = Vec_len(&h->instances);
+    for (size_t i = 0; i < instance_count; i++) {
+        const Instance* instance = Vec_get(&h->instances, i);
+        const Block* block = Vec_get(&h->blocks, instance->block);
+
+        size_t net_count = Vec_len(&block->netlist.nets);
+        for (size_t n = 0; n < net_count; n++) {
+            Net net = translated_net(Vec_get(&block->netlist.nets, n), instance->offset);
+            Vec_push(&nets, &net);
+        }
+    }
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = h->aabb
+    };
+}
+
+Net translated_net(const Net* net, Vector offset) {
+    size_t point_count = Vec_len(&net->points);
+    size_t segment_count = Vec_len(&net->segments);
+    Net res = {
+        .points = Vec_with_capacity(point_count, sizeof(Point)),
+        .segments = Vec_with_capacity(segment_count, sizeof(Segment))
+    };
+
+    for (size_t p = 0; p < point_count; p++) {
+        Point point = *(const Point*)Vec_get(&net->points, p);
+        point.x += offset.x;
+        point.y += offset.y;
+        Vec_push(&res.points, &point);
+    }
+
+    for (size_t s = 0; s < segment_count; s++) {
+        Segment segment = *(const Segment*)Vec_get(&net->segments, s);
+        Vec_push(&res.segments, &segment);
+    }
+
+    return res;
+}
+
+IntersectionVec Hierarchy_intersections(Hierarchy* h) {
+    IntersectionVec intersections = Vec_new(sizeof(Intersection));
+    size_t instance_count = Vec_len(&h->instances);
+
+    // Inside the instances: the block intersections, translated.
+    for (size_t i = 0; i < instance_count; i++) {
+        const Instance* instance = Vec_get(&h->instances, i);
+        const IntersectionVec* block_inters =
+            block_intersections(Vec_get_mut(&h->blocks, instance->block));
+
+        size_t inter_count = Vec_len(block_inters);
+        for (size_t j = 0; j < inter_count; j++) {
+            Intersection inter = *(const Intersection*)Vec_get(block_inters, j);
+            inter.a.net += instance->first_net;
+            inter.b.net += instance->first_net;
+            inter.point.x += instance->offset.x;
+            inter.point.y += instance->offset.y;
+            Vec_push(&intersections, &inter);
+        }
+    }
+
+    // Between the instances: only the overlapping ones, sorted along x
+    // so that the candidates of an instance are the next ones.
+    Vec boxes = Vec_with_capacity(instance_count, sizeof(InstanceBox));
+    for (size_t i = 0; i < instance_count; i++) {
+        const Instance* instance = Vec_get(&h->instances, i);
+        const Block* block = Vec_get(&h->blocks, instance->block);
+        InstanceBox box = {
+            .instance = i,
+            .aabb = translated_aabb(block->netlist.aabb, instance->offset)
+        };
+        Vec_push(&boxes, &box);
+    }
+    qsort(boxes.data, instance_count, sizeof(InstanceBox), box_order);
+
+    for (size_t i = 0; i < instance_count; i++) {
+        const InstanceBox* a = Vec_get(&boxes, i);
+
+        for (size_t j = i + 1; j < instance_count; j++) {
+            const InstanceBox* b = Vec_get(&boxes, j);
+            if (b->aabb.inf.x > a->aabb.sup.x) break;
+
+            if (b->aabb.inf.y <= a->aabb.sup.y && a->aabb.inf.y <= b->aabb.sup.y) {
+                add_crossings(&intersections, h, a, b);
+            }
+        }
+    }
+
+    Vec_drop(&boxes);
+
+    return intersections;
+}
+
+const IntersectionVec* block_intersections(Block* b) {
+    if (!b->has_intersections) {
+        b->intersections = Netlist_intersections_avl_sweep(&b->netlist);
+        b->has_intersections = true;
+    }
+    return &b->intersections;
+}
+
+int box_order(const void* a, const void* b) {
+    int32_t x_a = ((const InstanceBox*)a)->aabb.inf.x;
+    int32_t x_b = ((const InstanceBox*)b)->aabb.inf.x;
+    return (x_a > x_b) - (x_a < x_b);
+}
+
+void add_crossings(IntersectionVec* intersections, const Hierarchy* h,
+                   const InstanceBox* a, const InstanceBox* b) {
+    const Instance* a_instance = Vec_get(&h->instances, a->instance);
+    const Instance* b_instance = Vec_get(&h->instances, b->instance);
+    const Block* a_block = Vec_get(&h->blocks, a_instance->block);
+    const Block* b_block = Vec_get(&h->blocks, b_instance->block);
+
+    AABB overlap = {
+        .inf = { int32_t_max(a->aabb.inf.x, b->aabb.inf.x),
+                 int32_t_max(a->aabb.inf.y, b->aabb.inf.y) },
+        .sup = { int32_t_min(a->aabb.sup.x, b->aabb.sup.x),
+                 int32_t_min(a->aabb.sup.y, b->aabb.sup.y) }
+    };
+
+    IntersectionVec crossings = Netlist_intersections_between(
+        &a_block->netlist, a_instance->offset,
+        &b_block->netlist, b_instance->offset, overlap);
+
+    size_t crossing_count = Vec_len(&crossings);
+    for (size_t c = 0; c < crossing_count; c++) {
+        Intersection inter = *(const Intersection*)Vec_get(&crossings, c);
+        inter.a.net += a_instance->first_net;
+        inter.b.net += b_instance->first_net;
+        Vec_push(intersections, &inter);
+    }
+
+    Vec_drop(&crossings);
+}
@@ -0,0 +1,61 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include "netlist.h"
+
+/// Hierarchical netlists, made of blocks placed by translation.
+
+/*
+ * ABOUT THE HIERARCHY FILES:
+ *
+ *   block_count
+ *   block_number block_path
+ *   ...
+ *   instance_count
+ *   instance_number block_number offset_x offset_y
+ *   ...
+ *
+ * Every block is an ordinary netlist file, in any format, and relative
+ * block paths start from the directory of the hierarchy file.
+ * A block is loaded once whatever its number of instances.
+ *
+ * The nets of the hierarchy are numbered as if it was flattened:
+ * the nets of the first instance, then the nets of the second one, etc.
+ */
+
+typedef struct {
+    Netlist netlist;
+    /// The intersections inside the block, computed on first use.
+    IntersectionVec intersections;
+    bool has_intersections;
+} Block;
+
+typedef struct {
+    size_t block;
+    Vector offset;
+    /// Number of the first net of the instance in the flattened netlist.
+    size_t first_net;
+} Instance;
+
+typedef struct {
+    Vec blocks;
+    Vec instances;
+    size_t net_count;
+    AABB aabb;
+} Hierarchy;
+
+/// Loads a hierarchy and its blocks.
+Hierarchy Hierarchy_from_file(const char* path);
+
+/// Releases the hierarchy resources.
+void Hierarchy_drop(Hierarchy* h);
+
+/// Returns the netlist where every instance is expanded.
+Netlist Hierarchy_flatten(const Hierarchy* h);
+
+/// Finds the intersections of the flattened netlist without expanding it.
+/// The intersections inside a block are found once and translated for every
+/// instance, only the overlapping instances are swept together.
+IntersectionVec Hierarchy_intersections(Hierarchy* h);
+
+#endif // HIERARCHY_H
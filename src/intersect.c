@@ -1,16 +1,66 @@
 #include "util.h"
 #include "netlist.h"
 #include "display.h"
+#include "cache.h"
 
 /// Finds the intersections of the given netlist with the given method.
 
+void save_binary_intersections(const IntersectionVec* intersections, const char* path);
+IntersectionVec find_intersections(const Netlist* nl, IntersectionVec (*compute)(const Netlist*),
+                                   bool hilbert_order, bool normalized);
+
+void save_binary_intersections(const IntersectionVec* intersections, const char* path) {
+    Netlist_intersections_to_file((IntersectionVec*)intersections, path,
+                                  BINARY_INTERSECTIONS);
+}
+
+IntersectionVec find_intersections(const Netlist* nl, IntersectionVec (*compute)(const Netlist*),
+                                   bool hilbert_order, bool normalized) {
+    if (normalized) {
+        // Found in the normalized netlist, reported with the file segments.
+        Netlist normal = Netlist_normalized(nl);
+        IntersectionVec intersections = find_intersections(&normal, compute,
+                                                           hilbert_order, false);
+        Netlist_intersections_to_file_numbering(&normal, &intersections);
+        Netlist_drop(&normal);
+        return intersections;
+    }
+    if (!hilbert_order) {
+        return compute(nl);
+    }
+
+    // Found in the renumbered netlist, reported with the file numbering.
+    Netlist ordered = Netlist_to_hilbert_order(nl);
+    IntersectionVec intersections = compute(&ordered);
+    Netlist_intersections_to_file_numbering(&ordered, &intersections);
+    Netlist_drop(&ordered);
+    return intersections;
+}
+
 int main() {
     char file[255];
     ask_str("enter the netlist file name: ", file, 255);
     char* path = str_surround("netlists/", file, ".net");
 
+    char loader[20];
+    ask_str("choose a loader (stdio/mmap/parallel): ", loader, 20);
+
+    Netlist (*load)(const char*);
+    if (strcmp(loader, "stdio") == 0) {
+        load = Netlist_from_file;
+    } else if (strcmp(loader, "mmap") == 0) {
+        load = Netlist_from_mapped_file;
+    } else if (strcmp(loader, "parallel") == 0) {
+        load = Netlist_from_file_parallel;
+    } else {
+        perror("unknown loader");
+        exit(1);
+    }
+
     char method[20];
-    ask_str("choose a method (naive/vec_sweep/list_sweep/avl_sweep): ", method, 20);
+    ask_str("choose a method (naive/parallel_naive/vec_sweep/list_sweep/avl_sweep/"
+            "parallel_sweep/grid): ",
+            method, 20);
 
     Vec (*compute_intersections)(const Netlist*);
     if (strcmp(method, "naive") == 0) {
@@ -21,23 +71,84 @@ int main() {
         compute_intersections = Netlist_intersections_list_sweep;
     } else if (strcmp(method, "avl_sweep") == 0) {
         compute_intersections = Netlist_intersections_avl_sweep;
+    } else if (strcmp(method, "parallel_naive") == 0) {
+        compute_intersections = Netlist_intersections_parallel_naive;
+    } else if (strcmp(method, "parallel_sweep") == 0) {
+        compute_intersections = Netlist_intersections_parallel_sweep;
+    } else if (strcmp(method, "grid") == 0) {
+        compute_intersections = Netlist_intersections_grid;
     } else {
         perror("unknown method");
         exit(1);
     }
 
+    char format[20];
+    ask_str("choose an intersection file format (binary/text): ", format, 20);
+
+    IntersectionFormat intersection_format;
+    if (strcmp(format, "binary") == 0) {
+        intersection_format = BINARY_INTERSECTIONS;
+    } else if (strcmp(format, "text") == 0) {
+        intersection_format = TEXT_INTERSECTIONS;
+    } else {
+        perror("unknown intersection file format");
+        exit(1);
+    }
+
+    char renumbered[20];
+    ask_str("renumber the nets along a Hilbert curve (yes/no): ", renumbered, 20);
+    bool use_hilbert_order = strcmp(renumbered, "yes") == 0;
+
+    char merged[20];
+    ask_str("merge the collinear segments and duplicate points (yes/no): ", merged, 20);
+    bool use_normalized = strcmp(merged, "yes") == 0;
+
+    char cached[20];
+    ask_str("use the cache (yes/no): ", cached, 20);
+    bool use_cache = strcmp(cached, "yes") == 0;
+
     char* intersection_path = change_extension(path, "int");
     char* display_path = change_extension(path, "ps");
     char* intersection_display_path = change_extension(path, "int.ps");
 
     printf("handling `%s` ... ", path);
 
-    Netlist netlist = Netlist_from_file(path);
+    Netlist netlist = load(path);
     Netlist_to_ps(&netlist, display_path);
 
-    Vec intersections = compute_intersections(&netlist);
+    Vec intersections;
+    if (use_cache) {
+        Cache cache = Cache_open(CACHE_DEFAULT_DIR, CACHE_DEFAULT_MAX_SIZE);
+        CacheKey key = CacheKey_add_str(CacheKey_add_file(CacheKey_new(), path), method);
+        if (use_hilbert_order) {
+            // The sweeps may report other pairs in the renumbered netlist.
+            key = CacheKey_add_str(key, "hilbert");
+        }
+        if (use_normalized) {
+            key = CacheKey_add_str(key, "normalized");
+        }
+
+        char* entry = Cache_get(&cache, key, "int");
+        if (entry) {
+            intersections = Netlist_intersections_from_file(&netlist, entry);
+            free(entry);
+        } else {
+            intersections = find_intersections(&netlist, compute_intersections,
+                                               use_hilbert_order, use_normalized);
+            Cache_put(&cache, key, "int",
+                      (void (*)(const void*, const char*))save_binary_intersections,
+                      &intersections);
+        }
+
+        Cache_print_stats(&cache);
+        Cache_drop(&cache);
+    } else {
+        intersections = find_intersections(&netlist, compute_intersections,
+                                           use_hilbert_order, use_normalized);
+    }
     size_t intersection_count = Vec_len(&intersections);
-    Netlist_intersections_to_file(&intersections, intersection_path);
+    Netlist_intersections_to_file(&intersections, intersection_path,
+                                  intersection_format);
     Netlist_intersections_to_ps(&intersections, &netlist,
                                 display_path, intersection_display_path);
     Vec_drop(&intersections);
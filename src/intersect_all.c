@@ -13,12 +13,11 @@ void handle(char* path) {
 
     char* intersection_path = change_extension(path, "int");
 
-    Netlist netlist = Netlist_from_file(path);
-    Vec intersections = Netlist_intersections_avl_sweep(&netlist);
-    Netlist_intersections_to_file(&intersections, intersection_path);
+    Vec intersections = Netlist_file_intersections_avl_sweep(path);
+    Netlist_intersections_to_file(&intersections, intersection_path,
+                                  BINARY_INTERSECTIONS);
 
     Vec_drop(&intersections);
-    Netlist_drop(&netlist);
 
     free(intersection_path);
 
@@ -1,6 +1,7 @@
 #include <time.h>
 
 #include "util.h"
+#include "arena.h"
 #include "netlist.h"
 
 /// Compares the different intersection finding methods.
@@ -18,7 +19,9 @@ int main() {
     clock_t time_mark, delta_time;
     double delta_sec;
     FILE* bench_data = fopen("intersect_bench/data", "w");
-    fprintf(bench_data, "%zu 0 0 0 0 0\n", Vec_len(&paths) + 1); // placeholder
+    fprintf(bench_data, "%zu 0 0 0 0 0 0 0 0\n", Vec_len(&paths) + 1); // placeholder
+
+    Arena arena = Arena_new(ARENA_DEFAULT_CHUNK_SIZE, false);
 
     char* path;
     while (Vec_pop(&paths, &path)) {
@@ -53,17 +56,41 @@ int main() {
         uint32_t avl_sweep_time = (uint32_t)delta_time;
         Vec_drop(&intersections);
 
+        // The chunks of the previous netlists are reused.
+        measure_exec_time("   avl sweep (arena)",
+            intersections = Netlist_intersections_avl_sweep_in(&netlist, Arena_allocator(&arena));
+        )
+        uint32_t avl_arena_sweep_time = (uint32_t)delta_time;
+        Arena_reset(&arena);
+
+        // The breakpoints popped from a heap instead of being sorted at once.
+        measure_exec_time("   avl sweep (heap)",
+            intersections = Netlist_intersections_avl_heap_sweep(&netlist);
+        )
+        uint32_t avl_heap_sweep_time = (uint32_t)delta_time;
+        Vec_drop(&intersections);
+        printf("   sorted breakpoints speedup: %.2f\n",
+               (double)avl_heap_sweep_time/(avl_sweep_time ? avl_sweep_time : 1));
+
+        measure_exec_time("   grid",
+            intersections = Netlist_intersections_grid(&netlist);
+        )
+        uint32_t grid_time = (uint32_t)delta_time;
+        Vec_drop(&intersections);
+
         Netlist_drop(&netlist);
 
-        fprintf(bench_data, "%zu %zu %u %u %u %u\n", Vec_len(&paths) + 1, seg_count,
-                naive_time, vec_sweep_time, list_sweep_time, avl_sweep_time);
+        fprintf(bench_data, "%zu %zu %u %u %u %u %u %u %u\n", Vec_len(&paths) + 1, seg_count,
+                naive_time, vec_sweep_time, list_sweep_time, avl_sweep_time,
+                avl_arena_sweep_time, avl_heap_sweep_time, grid_time);
         puts(TERM_GREEN("   ✓"));
         free(path);
     }
 
-    fputs("0 0 0 0 0 0\n", bench_data); // placeholder
+    fputs("0 0 0 0 0 0 0 0 0\n", bench_data); // placeholder
     fclose(bench_data);
 
+    Arena_drop(&arena);
     Vec_drop(&paths);
 
     return EXIT_SUCCESS;
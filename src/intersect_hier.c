@@ -0,0 +1,50 @@
+#include "util.h"
+#include "netlist.h"
+#include "hierarchy.h"
+
+/// Finds the intersections of the given hierarchical netlist.
+
+int main() {
+    char file[255];
+    ask_str("enter the hierarchy file name: ", file, 255);
+    char* path = str_surround("netlists/", file, ".hier");
+
+    char format[20];
+    ask_str("choose an intersection file format (binary/text): ", format, 20);
+
+    IntersectionFormat intersection_format;
+    if (strcmp(format, "binary") == 0) {
+        intersection_format = BINARY_INTERSECTIONS;
+    } else if (strcmp(format, "text") == 0) {
+        intersection_format = TEXT_INTERSECTIONS;
+    } else {
+        perror("unknown intersection file format");
+        exit(1);
+    }
+
+    char* intersection_path = change_extension(path, "int");
+
+    printf("handling `%s` ... ", path);
+
+    Hierarchy hierarchy = Hierarchy_from_file(path);
+    Vec intersections = Hierarchy_intersections(&hierarchy);
+    size_t intersection_count = Vec_len(&intersections);
+    Netlist_intersections_to_file(&intersections, intersection_path,
+                                  intersection_format);
+    Vec_drop(&intersections);
+
+    size_t block_count = Vec_len(&hierarchy.blocks);
+    size_t instance_count = Vec_len(&hierarchy.instances);
+    size_t net_count = hierarchy.net_count;
+    Hierarchy_drop(&hierarchy);
+
+    free(intersection_path);
+    free(path);
+
+    printf(TERM_GREEN("✓")"\n");
+
+    printf("%zu blocks, %zu instances, %zu nets\n", block_count, instance_count, net_count);
+    printf("%zu intersections found\n", intersection_count);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include <time.h>
+
+#include "util.h"
+#include "netlist.h"
+
+/// Compares the nested netlist layout (one pair of vectors per net)
+/// with the flat layout (one array of points and one of segments).
+
+/// Small netlists load too fast to be measured once.
+#define REPEAT 10
+
+// Wall clock time, like in `load_bench`.
+#define measure_time(msg, block)                                        \
+    timespec_get(&time_mark, TIME_UTC);                                 \
+    for (size_t r = 0; r < REPEAT; r++) {                               \
+        block                                                           \
+    }                                                                   \
+    timespec_get(&time_end, TIME_UTC);                                  \
+    delta_sec = ((double)(time_end.tv_sec - time_mark.tv_sec) +         \
+                 (double)(time_end.tv_nsec - time_mark.tv_nsec)/1e9)/REPEAT; \
+    printf(msg": %f s\n", delta_sec);
+
+/// Returns the number of bytes allocated for the netlist,
+/// and sets `alloc_count` to the number of allocations.
+size_t footprint(const Netlist* nl, size_t* alloc_count);
+
+size_t footprint(const Netlist* nl, size_t* alloc_count) {
+    size_t bytes = nl->nets.cap*sizeof(Net);
+    *alloc_count = 1;
+
+    if (nl->points.data) {
+        *alloc_count += 2;
+        return bytes + nl->points.cap*sizeof(Point) + nl->segments.cap*sizeof(Segment);
+    }
+
+    size_t net_count = Vec_len(&nl->nets);
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        bytes += net->points.cap*sizeof(Point) + net->segments.cap*sizeof(Segment);
+    }
+    *alloc_count += 2*net_count;
+    return bytes;
+}
+
+int main() {
+    Vec paths = find("netlists/*.net");
+
+    struct timespec time_mark, time_end;
+    double delta_sec;
+    FILE* bench_data = fopen("layout_bench/data", "w");
+    fprintf(bench_data, "%zu 0 0 0 0 0 0 0 0\n", Vec_len(&paths) + 1); // placeholder
+
+    char* path;
+    while (Vec_pop(&paths, &path)) {
+        printf(" - handling `%s`:\n", path);
+
+        measure_time("   nested load",
+            Netlist netlist = Netlist_from_mapped_file(path);
+            Netlist_drop(&netlist);
+        )
+        double nested_load = delta_sec;
+
+        measure_time("   flat load",
+            Netlist netlist = Netlist_from_file_flat(path);
+            Netlist_drop(&netlist);
+        )
+        double flat_load = delta_sec;
+
+        Netlist nested = Netlist_from_mapped_file(path);
+        Netlist flat = Netlist_from_file_flat(path);
+
+        size_t nested_allocs, flat_allocs;
+        size_t nested_bytes = footprint(&nested, &nested_allocs);
+        size_t flat_bytes = footprint(&flat, &flat_allocs);
+        printf("   nested footprint: %zu B in %zu allocations\n", nested_bytes, nested_allocs);
+        printf("   flat footprint: %zu B in %zu allocations\n", flat_bytes, flat_allocs);
+
+        IntersectionVec intersections;
+        measure_time("   nested avl sweep",
+            intersections = Netlist_intersections_avl_sweep(&nested);
+            Vec_drop(&intersections);
+        )
+        double nested_sweep = delta_sec;
+
+        measure_time("   flat avl sweep",
+            intersections = Netlist_intersections_avl_sweep(&flat);
+            Vec_drop(&intersections);
+        )
+        double flat_sweep = delta_sec;
+
+        Netlist_drop(&nested);
+        Netlist_drop(&flat);
+
+        fprintf(bench_data, "%zu %f %f %zu %zu %zu %zu %f %f\n", Vec_len(&paths) + 1,
+                nested_load, flat_load,
+                nested_bytes, flat_bytes, nested_allocs, flat_allocs,
+                nested_sweep, flat_sweep);
+        puts(TERM_GREEN("   ✓"));
+        free(path);
+    }
+
+    fputs("0 0 0 0 0 0 0 0 0\n", bench_data); // placeholder
+    fclose(bench_data);
+
+    Vec_drop(&paths);
+
+    return EXIT_SUCCESS;
+}
@@ -1,10 +1,16 @@
 #include "list.h"
 
 static
-ListNode* new_node(void* e, size_t elem_size, ListNode* next);
+ListNode* new_node(List* l, void* e, ListNode* next);
+static
+void drop_node(List* l, ListNode* n);
 
 List List_new(size_t elem_size) {
-    return (List) { .head = NULL, .len = 0, .elem_size = elem_size };
+    return List_new_in(elem_size, NULL);
+}
+
+List List_new_in(size_t elem_size, Allocator* a) {
+    return (List) { .head = NULL, .len = 0, .elem_size = elem_size, .allocator = a };
 }
 
 void List_clear(List* l) {
@@ -35,30 +41,33 @@ void* List_peek(List* l) {
 }
 
 void List_push(List* l, void* e) {
-    ListNode* new_head = new_node(e, l->elem_size, l->head);
+    ListNode* new_head = new_node(l, e, l->head);
     l->head = new_head;
     l->len++;
 }
 
-ListNode* new_node(void* e, size_t elem_size, ListNode* next) {
-    ListNode* n = malloc(sizeof(ListNode));
-    assert_alloc(n);
+ListNode* new_node(List* l, void* e, ListNode* next) {
+    ListNode* n = Allocator_alloc(l->allocator, sizeof(ListNode));
 
-    void* elem = malloc(elem_size); // should avoid double allocation
-    memcpy(elem, e, elem_size);
+    void* elem = Allocator_alloc(l->allocator, l->elem_size); // should avoid double allocation
+    memcpy(elem, e, l->elem_size);
 
     *n = (ListNode) { .elem = elem, .next = next };
     return n;
 }
 
+void drop_node(List* l, ListNode* n) {
+    Allocator_free(l->allocator, n->elem, l->elem_size);
+    Allocator_free(l->allocator, n, sizeof(ListNode));
+}
+
 bool List_pop(List* l, void* e) {
     if (List_is_empty(l)) {
         return false;
     } else {
         if (e) memcpy(e, l->head->elem, l->elem_size);
         ListNode* new_head = l->head->next;
-        free(l->head->elem);
-        free(l->head);
+        drop_node(l, l->head);
         l->head = new_head;
         l->len--;
         return true;
@@ -93,15 +102,14 @@ void* ListNode_elem_mut(ListNode* n) {
 void List_remove(List* l, ListNode* n) {
     if (n->next) {
         ListNode* new_next = n->next->next;
-        free(n->next->elem);
-        free(n->next);
+        drop_node(l, n->next);
         n->next = new_next;
         l->len--;
     }
 }
 
 void List_insert(List* l, ListNode* n, void* e) {
-    ListNode* i = new_node(e, l->elem_size, n->next);
+    ListNode* i = new_node(l, e, n->next);
     n->next = i;
     l->len++;
 }
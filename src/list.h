@@ -15,12 +15,17 @@ typedef struct {
     ListNode* head;
     size_t len;
     size_t elem_size;
+    /// Where the nodes are allocated, `NULL` for the heap.
+    Allocator* allocator;
 } List;
 
 /// Creates an empty list.
 /// No allocation is done.
 List List_new(size_t elem_size);
 
+/// Creates an empty list like `List_new`, allocating the nodes with `a`.
+List List_new_in(size_t elem_size, Allocator* a);
+
 /// Clears the list by removing all its elements.
 void List_clear(List* l);
 
@@ -0,0 +1,123 @@
+#include <time.h>
+
+#include "util.h"
+#include "mapped_file.h"
+#include "tokenizer.h"
+#include "netlist.h"
+#include "netlist_binary.h"
+#include "netlist_compressed.h"
+
+/// Compares the different netlist loaders.
+
+/// Where the binary version of the netlists is written.
+#define BINARY_PATH "load_bench/netlist.bin"
+/// Where the compressed version of the netlists is written.
+#define COMPRESSED_PATH "load_bench/netlist.znet"
+
+/// Small netlists load too fast to be measured once.
+#define LOAD_REPEAT 10
+
+// Wall clock time, `clock()` would add up the time of every thread.
+// Rates are always given relative to the size of the text file.
+#define measure_load_rate(msg, load, load_path)                         \
+    timespec_get(&time_mark, TIME_UTC);                                 \
+    for (size_t r = 0; r < LOAD_REPEAT; r++) {                          \
+        Netlist netlist = load(load_path);                              \
+        Netlist_drop(&netlist);                                         \
+    }                                                                   \
+    timespec_get(&time_end, TIME_UTC);                                  \
+    delta_sec = (double)(time_end.tv_sec - time_mark.tv_sec) +          \
+                (double)(time_end.tv_nsec - time_mark.tv_nsec)/1e9;     \
+    rate = ((double)(file_size*LOAD_REPEAT)/1e6)/delta_sec;             \
+    printf(msg": %f MB/s\n", rate);
+
+#define TOKENIZER_COUNT 3
+
+/// Returns the cost per byte in nanoseconds of tokenizing the file with `t`,
+/// or 0 if the processor does not support `t`.
+double tokenizer_cost(Tokenizer t, const MappedFile* mf);
+
+double tokenizer_cost(Tokenizer t, const MappedFile* mf) {
+    if (!Tokenizer_is_supported(t)) return 0;
+    Tokenizer_select(t);
+
+    struct timespec time_mark, time_end;
+    timespec_get(&time_mark, TIME_UTC);
+    int64_t values[4];
+    int64_t sum = 0; // keeps the work from being optimized away
+    for (size_t r = 0; r < LOAD_REPEAT; r++) {
+        Scanner s = Scanner_new(mf->data, mf->len);
+        while (!Scanner_is_empty(&s)) {
+            size_t count = Tokenizer_line(&s, values, 4);
+            if (count > 0 && count != TOKENIZER_MALFORMED) sum += values[0];
+        }
+    }
+    timespec_get(&time_end, TIME_UTC);
+    double delta_ns = (double)(time_end.tv_sec - time_mark.tv_sec)*1e9 +
+                      (double)(time_end.tv_nsec - time_mark.tv_nsec);
+
+    Tokenizer_select(Tokenizer_best());
+    return (sum == INT64_MIN) ? 0 : delta_ns/(double)(mf->len*LOAD_REPEAT);
+}
+
+int main() {
+    Vec paths = find("netlists/*.net");
+
+    struct timespec time_mark, time_end;
+    double delta_sec, rate;
+    FILE* bench_data = fopen("load_bench/data", "w");
+    fprintf(bench_data, "%zu 0 0 0 0 0 0 0 0 0 0\n", Vec_len(&paths) + 1); // placeholder
+
+    char* path;
+    while (Vec_pop(&paths, &path)) {
+        printf(" - handling `%s`:\n", path);
+
+        MappedFile mf = MappedFile_open(path);
+        size_t file_size = mf.len;
+        double costs[TOKENIZER_COUNT];
+        for (Tokenizer t = SCALAR_TOKENIZER; t <= AVX2_TOKENIZER; t++) {
+            costs[t] = tokenizer_cost(t, &mf);
+            printf("   %s tokenizer: %f ns/B\n", Tokenizer_name(t), costs[t]);
+        }
+        MappedFile_drop(&mf);
+
+        measure_load_rate("   stdio", Netlist_from_file, path)
+        double stdio_rate = rate;
+
+        measure_load_rate("   mmap", Netlist_from_mapped_file, path)
+        double mmap_rate = rate;
+
+        measure_load_rate("   parallel", Netlist_from_file_parallel, path)
+        double parallel_rate = rate;
+
+        Netlist text_netlist = Netlist_from_file(path);
+        Netlist_to_binary_file(&text_netlist, BINARY_PATH);
+        Netlist_to_compressed_file(&text_netlist, COMPRESSED_PATH);
+        Netlist_drop(&text_netlist);
+        measure_load_rate("   binary", Netlist_from_binary_file, BINARY_PATH)
+        double binary_rate = rate;
+        remove(BINARY_PATH);
+
+        MappedFile compressed = MappedFile_open(COMPRESSED_PATH);
+        double compression_ratio = (double)file_size/(double)compressed.len;
+        MappedFile_drop(&compressed);
+        measure_load_rate("   compressed", Netlist_from_compressed_file, COMPRESSED_PATH)
+        double compressed_rate = rate;
+        printf("   compression ratio: %f\n", compression_ratio);
+        remove(COMPRESSED_PATH);
+
+        fprintf(bench_data, "%zu %zu %f %f %f %f %f %f %f %f %f\n", Vec_len(&paths) + 1, file_size,
+                stdio_rate, mmap_rate, parallel_rate,
+                costs[SCALAR_TOKENIZER], costs[SSE42_TOKENIZER], costs[AVX2_TOKENIZER],
+                binary_rate, compressed_rate, compression_ratio);
+        puts(TERM_GREEN("   ✓"));
+        free(path);
+    }
+
+    fputs("0 0 0 0 0 0 0 0 0 0 0\n", bench_data); // placeholder
+    fclose(bench_data);
+
+    Vec_drop(&paths);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+
+MappedFile MappedFile_open(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("cannot open file to map");
+        exit(1);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("cannot stat file to map");
+        exit(1);
+    }
+
+    size_t len = (size_t)st.st_size;
+    const char* data = NULL;
+    // `mmap` refuses empty mappings.
+    if (len > 0) {
+        void* m = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) {
+            perror("cannot map file");
+            exit(1);
+        }
+        // The loaders read the file front to back.
+        posix_madvise(m, len, POSIX_MADV_SEQUENTIAL);
+        data = m;
+    }
+
+    close(fd);
+
+    return (MappedFile) {
+        .data = data,
+        .len = len
+    };
+}
+
+void MappedFile_drop(MappedFile* mf) {
+    if (mf->data) {
+        munmap((void*)mf->data, mf->len);
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "core.h"
+
+/// A file mapped read-only in memory.
+
+typedef struct {
+    const char* data;
+    size_t len;
+} MappedFile;
+
+/// Maps the whole file found at `path`.
+/// Fires an error if the file cannot be opened or mapped.
+MappedFile MappedFile_open(const char* path);
+
+/// Unmaps the file.
+void MappedFile_drop(MappedFile* mf);
+
+#endif // MAPPED_FILE_H
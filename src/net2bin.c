@@ -0,0 +1,36 @@
+#include "util.h"
+#include "netlist.h"
+#include "netlist_binary.h"
+#include "netlist_compressed.h"
+
+/// Converts a text netlist to the binary or the compressed format.
+
+int main() {
+    char input[255];
+    ask_str("enter the text netlist path: ", input, 255);
+    char output[255];
+    ask_str("enter the output netlist path: ", output, 255);
+
+    char format[20];
+    ask_str("choose an output format (binary/compressed): ", format, 20);
+
+    void (*save)(const Netlist*, const char*);
+    if (strcmp(format, "binary") == 0) {
+        save = Netlist_to_binary_file;
+    } else if (strcmp(format, "compressed") == 0) {
+        save = Netlist_to_compressed_file;
+    } else {
+        perror("unknown netlist format");
+        exit(1);
+    }
+
+    printf("converting `%s` ... ", input);
+
+    Netlist netlist = Netlist_from_file(input);
+    save(&netlist, output);
+    Netlist_drop(&netlist);
+
+    printf(TERM_GREEN("✓")"\n");
+
+    return EXIT_SUCCESS;
+}
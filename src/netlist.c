@@ -1,6 +1,15 @@
 #include "binary_heap.h"
+#include "radix_sort.h"
+#include "crossing.h"
 #include "list.h"
 #include "avl_tree.h"
+#include "mapped_file.h"
+#include "scanner.h"
+#include "tokenizer.h"
+#include "parallel.h"
+#include "netlist_binary.h"
+#include "netlist_compressed.h"
+#include "writer.h"
 
 #include "netlist.h"
 
@@ -11,85 +20,346 @@ void point_from_line(Vec* points, const char* line);
 static
 void segment_from_line(Vec* segments, const char* line);
 static
+Net net_from_scanner(Scanner* s, Allocator* a);
+static
+void point_from_scanner(Vec* points, Scanner* s);
+static
+void segment_from_scanner(Vec* segments, Scanner* s);
+static
+bool read_integers(Scanner* s, int64_t* values, size_t count);
+static
 void check_net_segments(Net* net);
+static
+void check_index_fits(uint64_t n);
+static
+Net borrowed_net(PointVec* points, size_t first_point, size_t point_count,
+                 SegmentVec* segments, size_t first_segment, size_t segment_count);
+static
+NetVec borrowed_nets(PointVec* points, SegmentVec* segments, const Vec* counts);
+
+/// A Hilbert curve index, used to sort nets and segments.
+typedef struct {
+    uint64_t key;
+    index_t index;
+} HilbertKey;
+
+static
+uint64_t hilbert_index(uint32_t x, uint32_t y);
+static
+uint32_t hilbert_coordinate(int64_t v2, int32_t inf, int32_t sup);
+static
+HilbertKey hilbert_key(const AABB* aabb, int64_t x2, int64_t y2, size_t index);
+static
+int hilbert_order(const HilbertKey* a, const HilbertKey* b);
+static
+Vec sorted_net_keys(const Netlist* nl);
+static
+Vec sorted_segment_keys(const Net* net, const AABB* aabb);
+static
+size_t first_flat_segment(const Netlist* nl, size_t n);
+static
+void numbering_drop(NetlistNumbering* numbering);
+
+/// A point of a net with its index, used to find the duplicate points.
+typedef struct {
+    Point point;
+    index_t index;
+} PointKey;
+
+/// The segments of a net using a point, only the first two are kept.
+typedef struct {
+    size_t count;
+    index_t segments[2];
+} PointUse;
+
+static
+void normalize_net(const Net* net, PointVec* points, SegmentVec* segments,
+                   NetlistMerges* merges, Vec* counts);
+static
+Vec welded_points(const Net* net);
+static
+int point_key_order(const PointKey* a, const PointKey* b);
+static
+bool segments_join_at(const Net* net, const Segment* a, const Segment* b, index_t p);
+static
+index_t chain_root(index_t* parents, index_t s);
+static
+int32_t axis_coordinate(Point p, bool vertical);
+static
+void split_merged_intersections(const Netlist* nl, IntersectionVec* ints);
+static
+void merges_drop(NetlistMerges* merges);
+
+typedef struct {
+    Scanner scanner;
+    size_t first_net;
+    size_t net_count;
+    AABB aabb;
+    bool has_points;
+} NetChunk;
+
+typedef struct {
+    Vec* nets;
+    Vec* chunks;
+} ParallelLoad;
+
+static
+Vec split_net_chunks(Scanner* s, size_t net_count, size_t chunk_count);
+static
+void load_net_chunk(ParallelLoad* load, size_t c);
 
 static
 AABB compute_aabb(Vec* nets);
 static
 void AABB_include(AABB* aabb, Point p);
+static
+void AABB_include_net(AABB* aabb, bool* has_points, const Net* net);
 
 static
 void drop_net(Net* net);
 
-typedef struct {
-    const Point* beg;
-    const Point* end;
-} SegmentRef;
-
 static
-bool segment_intersects(SegmentRef a, SegmentRef b, Point* sect);
+ResolvedSegment resolve_segment(SegmentLoc loc, Point beg, Point end);
+static
+ResolvedSegment resolve_net_segment(const Net* net, SegmentLoc loc);
 static
-bool hv_intersects(SegmentRef h, SegmentRef v, Point* sect);
+bool segment_intersects(const ResolvedSegment* a, const ResolvedSegment* b, Point* sect);
+static
+bool hv_intersects(const ResolvedSegment* h, const ResolvedSegment* v, Point* sect);
 
+/// Listed in their order at a same x, so that a vertical segment meets
+/// the horizontal segments beginning or ending at its x.
 typedef enum {
     H_SEGMENT_BEGIN,
-    H_SEGMENT_END,
-    V_SEGMENT
+    V_SEGMENT,
+    H_SEGMENT_END
 } BreakpointType;
 
-typedef struct {
-    SegmentLoc loc;
-    SegmentRef ref;
-} BreakpointData;
+/// The breakpoints are packed in 64 bits keys which sort in the sweep order:
+/// the x coordinate with its sign bit flipped in the high half,
+/// then the breakpoint type and the segment index in the sweep table.
+#define BREAKPOINT_SEGMENT_BITS 30
 
 typedef struct {
-    BreakpointType type;
-    BreakpointData data;
-} Breakpoint;
+    SegmentTable segments;
+    /// The breakpoint keys, sorted at once when the sweep starts
+    /// and then read in order from `next` to `end`.
+    Vec breakpoints;
+    size_t next;
+    size_t end;
+    /// Set by `Netlist_intersections_avl_heap_sweep`: the keys are pushed
+    /// in `heap` when the sweep starts and popped one at a time.
+    bool use_heap;
+    BinaryHeap heap;
+} Sweep;
 
 static
-BinaryHeap sweep_init(const Netlist* nl);
+Sweep sweep_new(void);
+static
+Sweep sweep_init(const Netlist* nl, Allocator* a);
+static
+SegmentTable segment_table_new_in(const Netlist* nl, Allocator* a);
+static
+Sweep sweep_init_from_scanner(Scanner* s);
 static
-bool sweep_order(const Breakpoint* a, const Breakpoint* b);
+void sweep_memorize_net(Sweep* sw, size_t n, Scanner* s, Vec* points);
 static
-int32_t Breakpoint_get_x(const Breakpoint* b);
+void sweep_memorize_translated(Sweep* sw, const Netlist* nl, Vector offset,
+                               AABB region, size_t first_net);
 static
-void sweep_memorize(BinaryHeap* bh, SegmentLoc sl,
-                    const Net* net, const Segment* segment);
+uint64_t breakpoint_key(int32_t x, BreakpointType type, size_t segment);
+static
+bool breakpoint_key_order(const uint64_t* a, const uint64_t* b);
+static
+int32_t breakpoint_x(uint64_t key);
+static
+void sweep_memorize(Sweep* sw, SegmentLoc sl, Point beg, Point end);
+static
+void sweep_push_breakpoints(Sweep* sw, size_t i);
+static
+void sweep_start(Sweep* sw);
+static
+bool sweep_next(Sweep* sw, BreakpointType* type, ResolvedSegment** segment);
+static
+void sweep_drop(Sweep* sw);
 
 static
-void vec_sweep_comes_across(Vec* segments, BreakpointData* d);
+uint32_t crossing_net(index_t net);
 static
-void vec_sweep_goes_past(Vec* segments, const BreakpointData* d);
+void vec_sweep_comes_across(CrossingSet* segments, const ResolvedSegment* d, size_t id);
 static
-void vec_sweep_check_intersections(IntersectionVec* intersections,
-                                   const Vec* segments, const BreakpointData* d);
+void vec_sweep_goes_past(CrossingSet* segments, size_t id);
+static
+void vec_sweep_check_intersections(IntersectionVec* intersections, const CrossingSet* segments,
+                                   const Vec* table, const ResolvedSegment* vd, Vec* found);
 
 static
-void list_sweep_comes_across(List* segments, BreakpointData* d);
+void list_sweep_comes_across(List* segments, ResolvedSegment* d);
 static
-void list_sweep_goes_past(List* segments, const BreakpointData* d);
+void list_sweep_goes_past(List* segments, const ResolvedSegment* d);
 static
 void list_sweep_check_intersections(IntersectionVec* intersections,
-                                    const List* segments, const BreakpointData* d);
+                                    const List* segments, const ResolvedSegment* d);
 
 static
-int8_t compare(const BreakpointData* a, const BreakpointData* b);
+int8_t compare(const ResolvedSegment* a, const ResolvedSegment* b);
+static
+IntersectionVec avl_sweep(Sweep* sw, Allocator* a);
+static
+void avl_sweep_run(Sweep* sw, AVLTree* segments, IntersectionVec* intersections);
 static
-void avl_sweep_comes_across(AVLTree* segments, BreakpointData* d);
+void avl_sweep_comes_across(AVLTree* segments, ResolvedSegment* d);
 static
-void avl_sweep_goes_past(AVLTree* segments, BreakpointData *d);
+void avl_sweep_goes_past(AVLTree* segments, ResolvedSegment* d);
 static
 void avl_sweep_check_intersections(IntersectionVec* intersections,
-                                   const AVLTree* segments, const BreakpointData* d);
+                                   const AVLTree* segments, const ResolvedSegment* d);
 static
-const AVLNode* avl_find_sup_eq(const AVLNode* n, const BreakpointData* vd);
+const AVLNode* avl_find_sup_eq(const AVLNode* n, const ResolvedSegment* vd);
 static
 void avl_sweep_check_iter(IntersectionVec* intersections, const AVLNode* n,
-                          const BreakpointData* vd);
+                          const ResolvedSegment* vd);
 
+/// A strip of the x axis swept on its own: the breakpoints `[first, last)`
+/// of a sorted sweep, and the x of the first one.
+typedef struct {
+    size_t first;
+    size_t last;
+    int32_t x;
+} SweepStrip;
+
+typedef struct {
+    const Sweep* sweep;
+    const Vec* strips;
+    /// The table indices of the horizontal segments crossing the left edge
+    /// of every strip, one vector per strip.
+    const Vec* seeds;
+    Vec* results;
+} ParallelSweep;
+
+static
+Vec split_sweep_strips(const Sweep* sw, size_t strip_count);
+static
+Vec sweep_strip_seeds(const Sweep* sw, const Vec* strips);
+static
+void sweep_strip(ParallelSweep* ps, size_t i);
+static
+IntersectionVec gather_intersections(Vec* results);
+
+typedef struct {
+    const SegmentTable* table;
+    const CrossingSet* horizontals;
+    /// The vertical segments with their x and y swapped,
+    /// so that they are searched like the horizontal ones.
+    const CrossingSet* verticals;
+    /// The number of horizontal, and vertical, segments of the nets before every net,
+    /// and of all of them.
+    const Vec* h_offsets;
+    const Vec* v_offsets;
+    /// The table segments `[chunks[i], chunks[i + 1])` make the chunk `i`.
+    const Vec* chunks;
+    Vec* results;
+} ParallelNaive;
+
+static
+size_t naive_weight(const ParallelNaive* pn, const ResolvedSegment* d);
 static
-void graph_node_drop(GraphNode* n);
+Vec split_naive_chunks(const ParallelNaive* pn, size_t chunk_count);
+static
+void naive_chunk(ParallelNaive* pn, size_t i);
+
+/// A uniform grid over the netlist bounding box, see `Netlist_intersections_grid`.
+typedef struct {
+    Point origin;
+    int64_t cell_width;
+    int64_t cell_height;
+    size_t columns;
+    size_t rows;
+} Grid;
+
+/// The segments of one direction copied in every grid cell they touch,
+/// the ones of the c-th cell are `segments[offsets[c]..offsets[c + 1]]`.
+typedef struct {
+    Vec offsets;
+    Vec segments;
+} GridBins;
+
+static
+Grid grid_new(const AABB* aabb, const SegmentTable* table);
+static
+size_t grid_cell_count(int64_t width, int64_t height, int64_t cell_width, int64_t cell_height);
+static
+size_t grid_column(const Grid* g, int32_t x);
+static
+size_t grid_row(const Grid* g, int32_t y);
+static
+GridBins grid_bins(const Grid* g, const SegmentTable* table, bool vertical);
+static
+void grid_bins_drop(GridBins* bins);
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t count;
+} IntersectionHeader;
+
+typedef struct {
+    uint32_t a_net;
+    uint32_t a_seg;
+    uint32_t b_net;
+    uint32_t b_seg;
+} IntersectionRecord;
+
+typedef struct {
+    const Netlist* nl;
+    IntersectionVec* intersections;
+} IntersectionLoad;
+
+static
+const char intersection_magic[8] = "VIAINTB";
+#define INTERSECTION_FILE_VERSION 1
+
+static
+void intersections_to_text_file(IntersectionVec* inters, FILE* f);
+static
+void intersection_to_text(Writer* w, const void* inters, size_t i);
+static
+void intersections_to_binary_file(IntersectionVec* inters, FILE* f);
+static
+uint32_t checked_u32(size_t n);
+static
+void intersections_for_each(const char* path, void (*f)(void*, SegmentLoc, SegmentLoc),
+                            void* ctx);
+static
+void intersection_from_locs(IntersectionLoad* load, SegmentLoc a, SegmentLoc b);
+
+typedef struct {
+    GraphEdgeVec* edges;
+    const Vec* net_offsets;
+    const Netlist* nl;
+} GraphConflicts;
+
+static
+void graph_add_conflict(GraphConflicts* gc, SegmentLoc a_loc, SegmentLoc b_loc);
+static
+void graph_push_edge(GraphEdgeVec* edges, size_t u, size_t v);
+static
+GraphAdjacency adjacency_from_edges(size_t node_count, const GraphEdgeVec* edges,
+                                    Allocator* a);
+static
+GraphAdjacency point_continuity(const GraphNodeVec* nodes, Allocator* a);
+static
+size_t segment_end_node(const GraphNodeVec* nodes, const GraphNode* node, index_t end);
+static
+void adjacency_drop(GraphAdjacency* adj);
+static
+Vec cuthill_mckee_order(const Graph* g);
+static
+size_t node_degree(const Graph* g, size_t n);
+static
+GraphAdjacency relabel_adjacency(const GraphAdjacency* adj, size_t node_count,
+                                 const index_t* order, const index_t* rank);
 
 typedef enum {
     UNVISITED_NODE,
@@ -97,6 +367,7 @@ typedef enum {
     B_OPENED_NODE,
     CLOSED_NODE
 } NodeMark;
+VEC_DEF(NodeMark)
 
 static
 Vec Graph_find_odd_cycle(const Graph* g, Vec* marks);
@@ -129,6 +400,18 @@ Netlist Netlist_from_file(const char* path) {
         exit(1);
     }
 
+    char magic[NETLIST_BINARY_MAGIC_LEN];
+    size_t magic_len = fread(magic, 1, NETLIST_BINARY_MAGIC_LEN, f);
+    if (is_binary_netlist(magic, magic_len)) {
+        fclose(f);
+        return Netlist_from_binary_file(path);
+    }
+    if (is_compressed_netlist(magic, magic_len)) {
+        fclose(f);
+        return Netlist_from_compressed_file(path);
+    }
+    rewind(f);
+
     char line[255];
     if (!fgets(line, 255, f)) {
         SYNTAX_ERROR("expected first line");
@@ -138,6 +421,7 @@ Netlist Netlist_from_file(const char* path) {
     if (sscanf(line, "%zu", &net_count) != 1) {
         SYNTAX_ERROR("expected net count on first line");
     }
+    check_index_fits(net_count);
 
     Vec nets = Vec_with_capacity(net_count, sizeof(Net));
 
@@ -164,6 +448,8 @@ Net net_from_file(FILE* f) {
     if (sscanf(line, "%*u %zu %zu", &point_count, &segment_count) != 2) {
         SYNTAX_ERROR("expected `net_number point_count segment_count` net description");
     }
+    check_index_fits(point_count);
+    check_index_fits(segment_count);
 
     Net n = {
         .points = Vec_with_capacity(point_count, sizeof(Point)),
@@ -198,13 +484,878 @@ void point_from_line(Vec* points, const char* line) {
 }
 
 void segment_from_line(Vec* segments, const char* line) {
-    Segment s;
-    if (sscanf(line, "%zu %zu", &s.beg, &s.end) != 2) {
+    size_t beg, end;
+    if (sscanf(line, "%zu %zu", &beg, &end) != 2) {
         SYNTAX_ERROR("expected `segment_begin segment_end` segment description");
     }
+    check_index_fits(beg);
+    check_index_fits(end);
+    Segment s = { .beg = (index_t)beg, .end = (index_t)end };
     Vec_push(segments, &s);
 }
 
+Netlist Netlist_from_mapped_file(const char* path) {
+    return Netlist_from_mapped_file_in(path, NULL);
+}
+
+Netlist Netlist_from_mapped_file_in(const char* path, Allocator* a) {
+    MappedFile mf = MappedFile_open(path);
+    if (is_binary_netlist(mf.data, mf.len)) {
+        MappedFile_drop(&mf);
+        return Netlist_from_binary_file(path);
+    }
+    if (is_compressed_netlist(mf.data, mf.len)) {
+        MappedFile_drop(&mf);
+        return Netlist_from_compressed_file(path);
+    }
+    Scanner s = Scanner_new(mf.data, mf.len);
+
+    size_t net_count;
+    if (!Scanner_size(&s, &net_count)) {
+        SYNTAX_ERROR("expected net count on first line");
+    }
+    check_index_fits(net_count);
+    Scanner_skip_line(&s);
+
+    Vec nets = Vec_with_capacity_in(net_count, sizeof(Net), a);
+
+    for (size_t i = 0; i < net_count; i++) {
+        Net n = net_from_scanner(&s, a);
+        Vec_push(&nets, &n);
+    }
+
+    MappedFile_drop(&mf);
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = compute_aabb(&nets)
+    };
+}
+
+Net net_from_scanner(Scanner* s, Allocator* a) {
+    int64_t v[3];
+    if (!read_integers(s, v, 3) || v[0] < 0 || v[1] < 0 || v[2] < 0) {
+        SYNTAX_ERROR("expected `net_number point_count segment_count` net description");
+    }
+    size_t point_count = (size_t)v[1];
+    size_t segment_count = (size_t)v[2];
+    check_index_fits(point_count);
+    check_index_fits(segment_count);
+
+    Net n = {
+        .points = Vec_with_capacity_in(point_count, sizeof(Point), a),
+        .segments = Vec_with_capacity_in(segment_count, sizeof(Segment), a)
+    };
+
+    for (size_t i = 0; i < point_count; i++) {
+        point_from_scanner(&n.points, s);
+    }
+
+    for (size_t i = 0; i < segment_count; i++) {
+        segment_from_scanner(&n.segments, s);
+    }
+
+    check_net_segments(&n);
+
+    return n;
+}
+
+void point_from_scanner(Vec* points, Scanner* s) {
+    int64_t v[3];
+    if (!read_integers(s, v, 3) || v[0] < 0 ||
+        v[1] < INT32_MIN || v[1] > INT32_MAX ||
+        v[2] < INT32_MIN || v[2] > INT32_MAX) {
+        SYNTAX_ERROR("expected `point_number point_x point_y` point description");
+    }
+    Point p = { .x = (int32_t)v[1], .y = (int32_t)v[2] };
+    PointVec_push(points, p);
+}
+
+bool read_integers(Scanner* s, int64_t* values, size_t count) {
+    // Reads a well-formed line of at least `count` integers.
+    size_t found = Tokenizer_line(s, values, count);
+    return found != TOKENIZER_MALFORMED && found >= count;
+}
+
+void segment_from_scanner(Vec* segments, Scanner* s) {
+    int64_t v[2];
+    if (!read_integers(s, v, 2) || v[0] < 0 || v[1] < 0) {
+        SYNTAX_ERROR("expected `segment_begin segment_end` segment description");
+    }
+    check_index_fits((uint64_t)v[0]);
+    check_index_fits((uint64_t)v[1]);
+    Segment seg = { .beg = (index_t)v[0], .end = (index_t)v[1] };
+    SegmentVec_push(segments, seg);
+}
+
+Netlist Netlist_from_file_parallel(const char* path) {
+    MappedFile mf = MappedFile_open(path);
+    if (is_binary_netlist(mf.data, mf.len)) {
+        MappedFile_drop(&mf);
+        return Netlist_from_binary_file(path);
+    }
+    if (is_compressed_netlist(mf.data, mf.len)) {
+        MappedFile_drop(&mf);
+        return Netlist_from_compressed_file(path);
+    }
+    Scanner s = Scanner_new(mf.data, mf.len);
+
+    size_t net_count;
+    if (!Scanner_size(&s, &net_count)) {
+        SYNTAX_ERROR("expected net count on first line");
+    }
+    check_index_fits(net_count);
+    Scanner_skip_line(&s);
+
+    // A few chunks per thread keep the threads busy when nets differ in size.
+    size_t thread_count = cpu_count();
+    Vec chunks = split_net_chunks(&s, net_count, 4*thread_count);
+
+    Vec nets = Vec_with_capacity(net_count, sizeof(Net));
+    Net empty = { .points = Vec_new(sizeof(Point)), .segments = Vec_new(sizeof(Segment)) };
+    for (size_t i = 0; i < net_count; i++) {
+        Vec_push(&nets, &empty);
+    }
+
+    ParallelLoad load = { .nets = &nets, .chunks = &chunks };
+    parallel_for(Vec_len(&chunks), thread_count,
+                 (void (*)(void*, size_t))load_net_chunk, &load);
+
+    bool has_points = false;
+    AABB aabb;
+    size_t chunk_count = Vec_len(&chunks);
+    for (size_t c = 0; c < chunk_count; c++) {
+        const NetChunk* chunk = Vec_get(&chunks, c);
+        if (!chunk->has_points) continue;
+
+        if (has_points) {
+            AABB_include(&aabb, chunk->aabb.inf);
+            AABB_include(&aabb, chunk->aabb.sup);
+        } else {
+            aabb = chunk->aabb;
+            has_points = true;
+        }
+    }
+    // Same behaviour as `compute_aabb`.
+    assert(has_points);
+
+    Vec_drop(&chunks);
+    MappedFile_drop(&mf);
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = aabb
+    };
+}
+
+Vec split_net_chunks(Scanner* s, size_t net_count, size_t chunk_count) {
+    Vec chunks = Vec_with_capacity(chunk_count, sizeof(NetChunk));
+    size_t chunk_bytes = Scanner_remaining(s) / chunk_count + 1;
+
+    NetChunk chunk = { .scanner = *s, .first_net = 0, .net_count = 0 };
+    for (size_t n = 0; n < net_count; n++) {
+        size_t number, point_count, segment_count;
+        if (!Scanner_size(s, &number) ||
+            !Scanner_size(s, &point_count) ||
+            !Scanner_size(s, &segment_count)) {
+            SYNTAX_ERROR("expected `net_number point_count segment_count` net description");
+        }
+        Scanner_skip_line(s);
+
+        // Only looking for line ends, the workers will parse the lines.
+        for (size_t l = 0; l < (point_count + segment_count); l++) {
+            Scanner_skip_line(s);
+        }
+        chunk.net_count++;
+
+        size_t chunk_len = (size_t)(s->pos - chunk.scanner.pos);
+        if (chunk_len >= chunk_bytes || n + 1 == net_count) {
+            chunk.scanner.end = s->pos;
+            Vec_push(&chunks, &chunk);
+            chunk = (NetChunk) { .scanner = *s, .first_net = n + 1, .net_count = 0 };
+        }
+    }
+
+    return chunks;
+}
+
+void load_net_chunk(ParallelLoad* load, size_t c) {
+    NetChunk* chunk = Vec_get_mut(load->chunks, c);
+    chunk->has_points = false;
+
+    for (size_t n = 0; n < chunk->net_count; n++) {
+        Net* net = Vec_get_mut(load->nets, chunk->first_net + n);
+        *net = net_from_scanner(&chunk->scanner, NULL);
+        AABB_include_net(&chunk->aabb, &chunk->has_points, net);
+    }
+}
+
+Netlist Netlist_from_file_flat(const char* path) {
+    MappedFile mf = MappedFile_open(path);
+    if (is_binary_netlist(mf.data, mf.len)) {
+        MappedFile_drop(&mf);
+        return Netlist_from_binary_file(path);
+    }
+    if (is_compressed_netlist(mf.data, mf.len)) {
+        MappedFile_drop(&mf);
+        Netlist nl = Netlist_from_compressed_file(path);
+        Netlist flat = Netlist_to_flat(&nl);
+        Netlist_drop(&nl);
+        return flat;
+    }
+    Scanner s = Scanner_new(mf.data, mf.len);
+
+    size_t net_count;
+    if (!Scanner_size(&s, &net_count)) {
+        SYNTAX_ERROR("expected net count on first line");
+    }
+    check_index_fits(net_count);
+    Scanner_skip_line(&s);
+
+    PointVec points = Vec_new(sizeof(Point));
+    SegmentVec segments = Vec_new(sizeof(Segment));
+    // Point and segment counts of every net, the arrays move while growing.
+    Vec counts = Vec_with_capacity(2*net_count, sizeof(size_t));
+
+    for (size_t n = 0; n < net_count; n++) {
+        int64_t v[3];
+        if (!read_integers(&s, v, 3) || v[0] < 0 || v[1] < 0 || v[2] < 0) {
+            SYNTAX_ERROR("expected `net_number point_count segment_count` net description");
+        }
+        size_t point_count = (size_t)v[1];
+        size_t segment_count = (size_t)v[2];
+        check_index_fits(point_count);
+        check_index_fits(segment_count);
+        size_t first_point = Vec_len(&points);
+        size_t first_segment = Vec_len(&segments);
+
+        for (size_t i = 0; i < point_count; i++) {
+            point_from_scanner(&points, &s);
+        }
+
+        for (size_t i = 0; i < segment_count; i++) {
+            segment_from_scanner(&segments, &s);
+        }
+
+        Net net = borrowed_net(&points, first_point, point_count,
+                               &segments, first_segment, segment_count);
+        check_net_segments(&net);
+
+        Vec_push(&counts, &point_count);
+        Vec_push(&counts, &segment_count);
+    }
+
+    MappedFile_drop(&mf);
+
+    NetVec nets = borrowed_nets(&points, &segments, &counts);
+    Vec_drop(&counts);
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = compute_aabb(&nets),
+        .points = points,
+        .segments = segments
+    };
+}
+
+Netlist Netlist_to_flat(const Netlist* nl) {
+    size_t net_count = Vec_len(&nl->nets);
+    size_t point_count = 0, segment_count = 0;
+    Vec counts = Vec_with_capacity(2*net_count, sizeof(size_t));
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        size_t net_point_count = Vec_len(&net->points);
+        size_t net_segment_count = Vec_len(&net->segments);
+        Vec_push(&counts, &net_point_count);
+        Vec_push(&counts, &net_segment_count);
+        point_count += net_point_count;
+        segment_count += net_segment_count;
+    }
+
+    PointVec points = Vec_with_capacity(point_count, sizeof(Point));
+    SegmentVec segments = Vec_with_capacity(segment_count, sizeof(Segment));
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        size_t net_point_count = Vec_len(&net->points);
+        size_t net_segment_count = Vec_len(&net->segments);
+        memcpy(Vec_unsafe_get_mut(&points, Vec_len(&points)),
+               net->points.data, net_point_count*sizeof(Point));
+        memcpy(Vec_unsafe_get_mut(&segments, Vec_len(&segments)),
+               net->segments.data, net_segment_count*sizeof(Segment));
+        points.len += net_point_count;
+        segments.len += net_segment_count;
+    }
+
+    NetVec nets = borrowed_nets(&points, &segments, &counts);
+    Vec_drop(&counts);
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = nl->aabb,
+        .points = points,
+        .segments = segments
+    };
+}
+
+Net borrowed_net(PointVec* points, size_t first_point, size_t point_count,
+                 SegmentVec* segments, size_t first_segment, size_t segment_count) {
+    // Borrowed vectors, they are never grown nor freed.
+    return (Net) {
+        .points = {
+            .data = (Point*)points->data + first_point, .elem_size = sizeof(Point),
+            .len = point_count, .cap = point_count
+        },
+        .segments = {
+            .data = (Segment*)segments->data + first_segment, .elem_size = sizeof(Segment),
+            .len = segment_count, .cap = segment_count
+        }
+    };
+}
+
+NetVec borrowed_nets(PointVec* points, SegmentVec* segments, const Vec* counts) {
+    size_t net_count = Vec_len(counts)/2;
+    NetVec nets = Vec_with_capacity(net_count, sizeof(Net));
+
+    size_t first_point = 0, first_segment = 0;
+    for (size_t n = 0; n < net_count; n++) {
+        size_t point_count = *(const size_t*)Vec_get(counts, 2*n);
+        size_t segment_count = *(const size_t*)Vec_get(counts, 2*n + 1);
+        Net net = borrowed_net(points, first_point, point_count,
+                               segments, first_segment, segment_count);
+        Vec_push(&nets, &net);
+        first_point += point_count;
+        first_segment += segment_count;
+    }
+
+    return nets;
+}
+
+Netlist Netlist_to_hilbert_order(const Netlist* nl) {
+    size_t net_count = Vec_len(&nl->nets);
+    Vec net_keys = sorted_net_keys(nl);
+
+    size_t point_count = 0, segment_count = 0;
+    Vec counts = Vec_with_capacity(2*net_count, sizeof(size_t));
+    for (size_t n = 0; n < net_count; n++) {
+        const HilbertKey* k = Vec_get(&net_keys, n);
+        const Net* net = Vec_get(&nl->nets, k->index);
+        size_t net_point_count = Vec_len(&net->points);
+        size_t net_segment_count = Vec_len(&net->segments);
+        Vec_push(&counts, &net_point_count);
+        Vec_push(&counts, &net_segment_count);
+        point_count += net_point_count;
+        segment_count += net_segment_count;
+    }
+
+    PointVec points = Vec_with_capacity(point_count, sizeof(Point));
+    SegmentVec segments = Vec_with_capacity(segment_count, sizeof(Segment));
+    NetlistNumbering numbering = {
+        .net_ids = Vec_with_capacity(net_count, sizeof(index_t)),
+        .net_ranks = Vec_with_capacity(net_count, sizeof(index_t)),
+        .segment_ids = Vec_with_capacity(segment_count, sizeof(index_t)),
+        .segment_ranks = Vec_with_capacity(segment_count, sizeof(index_t))
+    };
+    numbering.net_ranks.len = net_count;
+    numbering.segment_ranks.len = segment_count;
+    index_t* net_ranks = numbering.net_ranks.data;
+    index_t* segment_ranks = numbering.segment_ranks.data;
+
+    for (size_t n = 0; n < net_count; n++) {
+        index_t id = ((const HilbertKey*)Vec_get(&net_keys, n))->index;
+        const Net* net = Vec_get(&nl->nets, id);
+        Vec_push(&numbering.net_ids, &id);
+        net_ranks[id] = (index_t)n;
+
+        // The points are copied as is, the segments keep pointing to them.
+        size_t net_point_count = Vec_len(&net->points);
+        memcpy(Vec_unsafe_get_mut(&points, Vec_len(&points)),
+               net->points.data, net_point_count*sizeof(Point));
+        points.len += net_point_count;
+
+        size_t first_segment = Vec_len(&segments);
+        Vec segment_keys = sorted_segment_keys(net, &nl->aabb);
+        size_t net_segment_count = Vec_len(&segment_keys);
+        for (size_t s = 0; s < net_segment_count; s++) {
+            index_t seg_id = ((const HilbertKey*)Vec_get(&segment_keys, s))->index;
+            SegmentVec_push(&segments, *SegmentVec_at(&net->segments, seg_id));
+            Vec_push(&numbering.segment_ids, &seg_id);
+            segment_ranks[first_segment + seg_id] = (index_t)s;
+        }
+        Vec_drop(&segment_keys);
+    }
+    Vec_drop(&net_keys);
+
+    NetVec nets = borrowed_nets(&points, &segments, &counts);
+    Vec_drop(&counts);
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = nl->aabb,
+        .points = points,
+        .segments = segments,
+        .numbering = numbering
+    };
+}
+
+Vec sorted_net_keys(const Netlist* nl) {
+    size_t net_count = Vec_len(&nl->nets);
+    Vec keys = Vec_with_capacity(net_count, sizeof(HilbertKey));
+
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        AABB net_aabb = nl->aabb;
+        bool has_points = false;
+        AABB_include_net(&net_aabb, &has_points, net);
+        if (!has_points) {
+            net_aabb.sup = net_aabb.inf;
+        }
+
+        HilbertKey k = hilbert_key(&nl->aabb,
+                                   (int64_t)net_aabb.inf.x + net_aabb.sup.x,
+                                   (int64_t)net_aabb.inf.y + net_aabb.sup.y, n);
+        Vec_push(&keys, &k);
+    }
+
+    qsort(keys.data, net_count, sizeof(HilbertKey),
+          (int (*)(const void*, const void*))hilbert_order);
+    return keys;
+}
+
+Vec sorted_segment_keys(const Net* net, const AABB* aabb) {
+    size_t segment_count = Vec_len(&net->segments);
+    Vec keys = Vec_with_capacity(segment_count, sizeof(HilbertKey));
+
+    for (size_t s = 0; s < segment_count; s++) {
+        const Segment* segment = SegmentVec_at(&net->segments, s);
+        const Point* beg = Vec_get(&net->points, segment->beg);
+        const Point* end = Vec_get(&net->points, segment->end);
+        HilbertKey k = hilbert_key(aabb, (int64_t)beg->x + end->x,
+                                   (int64_t)beg->y + end->y, s);
+        Vec_push(&keys, &k);
+    }
+
+    qsort(keys.data, segment_count, sizeof(HilbertKey),
+          (int (*)(const void*, const void*))hilbert_order);
+    return keys;
+}
+
+HilbertKey hilbert_key(const AABB* aabb, int64_t x2, int64_t y2, size_t index) {
+    // `x2` and `y2` are doubled coordinates, so that centres stay integers.
+    return (HilbertKey) {
+        .key = hilbert_index(hilbert_coordinate(x2, aabb->inf.x, aabb->sup.x),
+                             hilbert_coordinate(y2, aabb->inf.y, aabb->sup.y)),
+        .index = (index_t)index
+    };
+}
+
+uint32_t hilbert_coordinate(int64_t v2, int32_t inf, int32_t sup) {
+    // Scales the doubled coordinate `v2` from `[2*inf, 2*sup]` to `[0, 2^16)`.
+    int64_t extent = 2*((int64_t)sup - inf) + 1;
+    return (uint32_t)(((v2 - 2*(int64_t)inf) << 16) / extent);
+}
+
+uint64_t hilbert_index(uint32_t x, uint32_t y) {
+    // Distance along the curve filling the 2^16 x 2^16 grid (Wikipedia `xy2d`).
+    const uint32_t n = (uint32_t)1 << 16;
+    uint64_t d = 0;
+    for (uint32_t s = n/2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += (uint64_t)s*s*((3*rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            uint32_t t = x;
+            x = y;
+            y = t;
+        }
+    }
+    return d;
+}
+
+int hilbert_order(const HilbertKey* a, const HilbertKey* b) {
+    // Ties keep the file order, so that the renumbering is deterministic.
+    if (a->key != b->key) return (a->key < b->key) ? -1 : 1;
+    return (a->index > b->index) - (a->index < b->index);
+}
+
+Netlist Netlist_normalized(const Netlist* nl) {
+    size_t net_count = Vec_len(&nl->nets);
+    PointVec points = Vec_new(sizeof(Point));
+    SegmentVec segments = Vec_new(sizeof(Segment));
+    Vec counts = Vec_with_capacity(2*net_count, sizeof(size_t));
+    NetlistMerges merges = {
+        .point_offsets = Vec_with_capacity(net_count + 1, sizeof(size_t)),
+        .segment_offsets = Vec_with_capacity(net_count + 1, sizeof(size_t)),
+        .points = Vec_new(sizeof(index_t)),
+        .segments = Vec_new(sizeof(index_t)),
+        .extents = Vec_new(sizeof(int32_t))
+    };
+
+    for (size_t n = 0; n < net_count; n++) {
+        Vec_push(&merges.point_offsets, &merges.points.len);
+        Vec_push(&merges.segment_offsets, &merges.segments.len);
+        normalize_net(Vec_get(&nl->nets, n), &points, &segments, &merges, &counts);
+    }
+    Vec_push(&merges.point_offsets, &merges.points.len);
+    Vec_push(&merges.segment_offsets, &merges.segments.len);
+
+    NetVec nets = borrowed_nets(&points, &segments, &counts);
+    Vec_drop(&counts);
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = nl->aabb,
+        .points = points,
+        .segments = segments,
+        .merges = merges
+    };
+}
+
+void normalize_net(const Net* net, PointVec* points, SegmentVec* segments,
+                   NetlistMerges* merges, Vec* counts) {
+    size_t point_count = Vec_len(&net->points);
+    size_t segment_count = Vec_len(&net->segments);
+    const index_t none = (index_t)-1;
+
+    Vec welds = welded_points(net);
+    SegmentVec welded = Vec_with_capacity(segment_count, sizeof(Segment));
+    Vec uses = Vec_with_capacity(point_count, sizeof(PointUse));
+    for (size_t p = 0; p < point_count; p++) {
+        Vec_push(&uses, &(PointUse) { .count = 0 });
+    }
+    for (size_t s = 0; s < segment_count; s++) {
+        const Segment* segment = SegmentVec_at(&net->segments, s);
+        Segment w = {
+            .beg = *(const index_t*)Vec_get(&welds, segment->beg),
+            .end = *(const index_t*)Vec_get(&welds, segment->end)
+        };
+        SegmentVec_push(&welded, w);
+
+        for (size_t e = 0; e < ((w.beg == w.end) ? 1 : 2); e++) {
+            PointUse* use = Vec_get_mut(&uses, (e == 0) ? w.beg : w.end);
+            if (use->count < 2) {
+                use->segments[use->count] = (index_t)s;
+            }
+            use->count++;
+        }
+    }
+
+    // The segments of a chain share the root of their `parents` tree,
+    // the points inside the chains are marked.
+    Vec parents = Vec_with_capacity(segment_count, sizeof(index_t));
+    parents.len = segment_count;
+    index_t* parent = parents.data;
+    for (size_t s = 0; s < segment_count; s++) {
+        parent[s] = (index_t)s;
+    }
+    Vec inner = Vec_with_capacity(point_count, sizeof(bool));
+    for (size_t p = 0; p < point_count; p++) {
+        Vec_push(&inner, &(bool) { false });
+    }
+    const PointUse* use = uses.data;
+    for (size_t p = 0; p < point_count; p++) {
+        if (use[p].count != 2) continue;
+        const Segment* a = SegmentVec_at(&welded, use[p].segments[0]);
+        const Segment* b = SegmentVec_at(&welded, use[p].segments[1]);
+        if (segments_join_at(net, a, b, (index_t)p)) {
+            parent[chain_root(parent, use[p].segments[0])] =
+                chain_root(parent, use[p].segments[1]);
+            ((bool*)inner.data)[p] = true;
+        }
+    }
+
+    // The ends of a chain are the lowest and highest ends of its segments.
+    SegmentVec ends = Vec_with_capacity(segment_count, sizeof(Segment));
+    for (size_t s = 0; s < segment_count; s++) {
+        SegmentVec_push(&ends, *SegmentVec_at(&welded, s));
+    }
+    for (size_t s = 0; s < segment_count; s++) {
+        const Segment* w = SegmentVec_at(&welded, s);
+        Segment* chain = SegmentVec_at_mut(&ends, chain_root(parent, (index_t)s));
+        Point beg = *PointVec_at(&net->points, w->beg);
+        Point end = *PointVec_at(&net->points, w->end);
+        Point chain_beg = *PointVec_at(&net->points, chain->beg);
+        Point chain_end = *PointVec_at(&net->points, chain->end);
+        bool vertical = chain_beg.x == chain_end.x;
+        if (axis_coordinate(beg, vertical) < axis_coordinate(chain_beg, vertical)) {
+            chain->beg = w->beg;
+        }
+        if (axis_coordinate(end, vertical) > axis_coordinate(chain_end, vertical)) {
+            chain->end = w->end;
+        }
+    }
+
+    // The points left are the first of their coordinates outside the chains.
+    const index_t* weld = welds.data;
+    Vec point_ranks = Vec_with_capacity(point_count, sizeof(index_t));
+    point_ranks.len = point_count;
+    index_t* point_rank = point_ranks.data;
+    size_t net_point_count = 0;
+    for (size_t p = 0; p < point_count; p++) {
+        point_rank[p] = none;
+        if (weld[p] == p && !((const bool*)inner.data)[p]) {
+            point_rank[p] = (index_t)net_point_count++;
+            PointVec_push(points, *PointVec_at(&net->points, p));
+        }
+    }
+    for (size_t p = 0; p < point_count; p++) {
+        index_t rank = point_rank[weld[p]];
+        Vec_push(&merges->points, (rank == none) ? &(index_t) { MERGED_POINT } : &rank);
+    }
+
+    // A chain becomes a segment where its first segment was.
+    Vec segment_ranks = Vec_with_capacity(segment_count, sizeof(index_t));
+    segment_ranks.len = segment_count;
+    index_t* segment_rank = segment_ranks.data;
+    for (size_t s = 0; s < segment_count; s++) {
+        segment_rank[s] = none;
+    }
+    size_t net_segment_count = 0;
+    for (size_t s = 0; s < segment_count; s++) {
+        index_t root = chain_root(parent, (index_t)s);
+        const Segment* chain = SegmentVec_at(&ends, root);
+        if (segment_rank[root] == none) {
+            segment_rank[root] = (index_t)net_segment_count++;
+            Segment merged = { .beg = point_rank[chain->beg], .end = point_rank[chain->end] };
+            SegmentVec_push(segments, merged);
+        }
+        Vec_push(&merges->segments, &segment_rank[root]);
+
+        const Segment* w = SegmentVec_at(&welded, s);
+        bool vertical = PointVec_at(&net->points, chain->beg)->x ==
+                        PointVec_at(&net->points, chain->end)->x;
+        int32_t lo = axis_coordinate(*PointVec_at(&net->points, w->beg), vertical);
+        int32_t hi = axis_coordinate(*PointVec_at(&net->points, w->end), vertical);
+        Vec_push(&merges->extents, &lo);
+        Vec_push(&merges->extents, &hi);
+    }
+
+    Vec_push(counts, &net_point_count);
+    Vec_push(counts, &net_segment_count);
+
+    Vec_drop(&segment_ranks);
+    Vec_drop(&point_ranks);
+    Vec_drop(&ends);
+    Vec_drop(&inner);
+    Vec_drop(&parents);
+    Vec_drop(&uses);
+    Vec_drop(&welded);
+    Vec_drop(&welds);
+}
+
+Vec welded_points(const Net* net) {
+    // Every point is welded into the first one with the same coordinates.
+    size_t point_count = Vec_len(&net->points);
+    Vec keys = Vec_with_capacity(point_count, sizeof(PointKey));
+    for (size_t p = 0; p < point_count; p++) {
+        PointKey k = { .point = *PointVec_at(&net->points, p), .index = (index_t)p };
+        Vec_push(&keys, &k);
+    }
+    qsort(keys.data, point_count, sizeof(PointKey),
+          (int (*)(const void*, const void*))point_key_order);
+
+    Vec welds = Vec_with_capacity(point_count, sizeof(index_t));
+    welds.len = point_count;
+    index_t* weld = welds.data;
+    const PointKey* key = keys.data;
+    index_t first = 0;
+    for (size_t k = 0; k < point_count; k++) {
+        if (k == 0 || key[k].point.x != key[k - 1].point.x ||
+                      key[k].point.y != key[k - 1].point.y) {
+            first = key[k].index;
+        }
+        weld[key[k].index] = first;
+    }
+
+    Vec_drop(&keys);
+    return welds;
+}
+
+int point_key_order(const PointKey* a, const PointKey* b) {
+    if (a->point.x != b->point.x) return (a->point.x < b->point.x) ? -1 : 1;
+    if (a->point.y != b->point.y) return (a->point.y < b->point.y) ? -1 : 1;
+    return (a->index > b->index) - (a->index < b->index);
+}
+
+bool segments_join_at(const Net* net, const Segment* a, const Segment* b, index_t p) {
+    // `a` and `b` must go on both sides of `p` along the same line,
+    // which excludes the segments reduced to a point.
+    Point at = *PointVec_at(&net->points, p);
+    Point a_end = *PointVec_at(&net->points, (a->beg == p) ? a->end : a->beg);
+    Point b_end = *PointVec_at(&net->points, (b->beg == p) ? b->end : b->beg);
+    if (a_end.x == at.x && b_end.x == at.x) {
+        return (a_end.y < at.y && b_end.y > at.y) || (a_end.y > at.y && b_end.y < at.y);
+    }
+    if (a_end.y == at.y && b_end.y == at.y) {
+        return (a_end.x < at.x && b_end.x > at.x) || (a_end.x > at.x && b_end.x < at.x);
+    }
+    return false;
+}
+
+index_t chain_root(index_t* parents, index_t s) {
+    while (parents[s] != s) {
+        parents[s] = parents[parents[s]];
+        s = parents[s];
+    }
+    return s;
+}
+
+int32_t axis_coordinate(Point p, bool vertical) {
+    return vertical ? p.y : p.x;
+}
+
+size_t first_flat_segment(const Netlist* nl, size_t n) {
+    // Renumbered netlists are flat, the nets borrow consecutive segments.
+    const Net* net = Vec_get(&nl->nets, n);
+    return (size_t)((const Segment*)net->segments.data - (const Segment*)nl->segments.data);
+}
+
+SegmentLoc Netlist_file_loc(const Netlist* nl, SegmentLoc loc) {
+    if (!Vec_is_empty(&nl->merges.segment_offsets)) {
+        size_t first = *(const size_t*)Vec_get(&nl->merges.segment_offsets, loc.net);
+        size_t last = *(const size_t*)Vec_get(&nl->merges.segment_offsets, loc.net + 1);
+        size_t s = first;
+        while (s < last && *(const index_t*)Vec_get(&nl->merges.segments, s) != loc.seg) {
+            s++;
+        }
+        assert(s < last);
+        return (SegmentLoc) { .net = loc.net, .seg = (index_t)(s - first) };
+    }
+    if (Vec_is_empty(&nl->numbering.net_ids)) {
+        return loc;
+    }
+    size_t first = first_flat_segment(nl, loc.net);
+    return (SegmentLoc) {
+        .net = *(const index_t*)Vec_get(&nl->numbering.net_ids, loc.net),
+        .seg = *(const index_t*)Vec_get(&nl->numbering.segment_ids, first + loc.seg)
+    };
+}
+
+SegmentLoc Netlist_loc_from_file(const Netlist* nl, SegmentLoc loc) {
+    if (!Vec_is_empty(&nl->merges.segment_offsets)) {
+        size_t first = *(const size_t*)Vec_get(&nl->merges.segment_offsets, loc.net);
+        size_t last = *(const size_t*)Vec_get(&nl->merges.segment_offsets, loc.net + 1);
+        // The segments of the nets are stored back to back, an index past the end of
+        // its net would give a segment of the next one.
+        if (loc.seg >= last - first) {
+            SYNTAX_ERROR("intersection file does not match the netlist");
+        }
+        return (SegmentLoc) {
+            .net = loc.net,
+            .seg = *(const index_t*)Vec_get(&nl->merges.segments, first + loc.seg)
+        };
+    }
+    if (Vec_is_empty(&nl->numbering.net_ids)) {
+        return loc;
+    }
+    index_t net = *(const index_t*)Vec_get(&nl->numbering.net_ranks, loc.net);
+    if (loc.seg >= Vec_len(&NetVec_at(&nl->nets, net)->segments)) {
+        SYNTAX_ERROR("intersection file does not match the netlist");
+    }
+    size_t first = first_flat_segment(nl, net);
+    return (SegmentLoc) {
+        .net = net,
+        .seg = *(const index_t*)Vec_get(&nl->numbering.segment_ranks, first + loc.seg)
+    };
+}
+
+void Netlist_intersections_to_file_numbering(const Netlist* nl, IntersectionVec* ints) {
+    if (!Vec_is_empty(&nl->merges.segment_offsets)) {
+        split_merged_intersections(nl, ints);
+        return;
+    }
+    IntersectionSpan span = IntersectionVec_span_mut(ints);
+    for (size_t i = 0; i < span.len; i++) {
+        span.data[i].a = Netlist_file_loc(nl, span.data[i].a);
+        span.data[i].b = Netlist_file_loc(nl, span.data[i].b);
+    }
+}
+
+void split_merged_intersections(const Netlist* nl, IntersectionVec* ints) {
+    const NetlistMerges* m = &nl->merges;
+    const size_t* segment_offsets = m->segment_offsets.data;
+    const index_t* merged = m->segments.data;
+    const int32_t* extents = m->extents.data;
+
+    // The file segments of every merged segment, in compressed sparse row form.
+    size_t segment_count = Vec_len(&nl->segments);
+    Vec offsets = Vec_with_capacity(segment_count + 1, sizeof(size_t));
+    for (size_t s = 0; s <= segment_count; s++) {
+        Vec_push(&offsets, &(size_t) { 0 });
+    }
+    size_t* offset = offsets.data;
+    size_t net_count = Vec_len(&nl->nets);
+    for (size_t n = 0; n < net_count; n++) {
+        size_t first = first_flat_segment(nl, n);
+        for (size_t s = segment_offsets[n]; s < segment_offsets[n + 1]; s++) {
+            offset[first + merged[s] + 1]++;
+        }
+    }
+    for (size_t s = 0; s < segment_count; s++) {
+        offset[s + 1] += offset[s];
+    }
+    Vec sources = Vec_with_capacity(Vec_len(&m->segments), sizeof(index_t));
+    sources.len = Vec_len(&m->segments);
+    index_t* source = sources.data;
+    Vec cursors = Vec_with_capacity(segment_count + 1, sizeof(size_t));
+    for (size_t s = 0; s <= segment_count; s++) {
+        Vec_push(&cursors, &offset[s]);
+    }
+    size_t* cursor = cursors.data;
+    for (size_t n = 0; n < net_count; n++) {
+        size_t first = first_flat_segment(nl, n);
+        for (size_t s = segment_offsets[n]; s < segment_offsets[n + 1]; s++) {
+            source[cursor[first + merged[s]]++] = (index_t)(s - segment_offsets[n]);
+        }
+    }
+    Vec_drop(&cursors);
+
+    // Every pair of file segments touching the point is an intersection.
+    IntersectionConstSpan found = IntersectionVec_span(ints);
+    IntersectionVec split = Vec_with_capacity(found.len, sizeof(Intersection));
+    for (size_t i = 0; i < found.len; i++) {
+        const Intersection* it = &found.data[i];
+        const SegmentLoc locs[2] = { it->a, it->b };
+        const index_t* side_sources[2];
+        size_t side_counts[2];
+        int32_t coordinates[2];
+        for (size_t k = 0; k < 2; k++) {
+            size_t flat = first_flat_segment(nl, locs[k].net) + locs[k].seg;
+            ResolvedSegment r = resolve_net_segment(Vec_get(&nl->nets, locs[k].net), locs[k]);
+            side_sources[k] = &source[offset[flat]];
+            side_counts[k] = offset[flat + 1] - offset[flat];
+            coordinates[k] = axis_coordinate(it->point, r.vertical);
+        }
+
+        for (size_t a = 0; a < side_counts[0]; a++) {
+            size_t a_extent = 2*(segment_offsets[it->a.net] + side_sources[0][a]);
+            if (coordinates[0] < extents[a_extent] || coordinates[0] > extents[a_extent + 1]) {
+                continue;
+            }
+            for (size_t b = 0; b < side_counts[1]; b++) {
+                size_t b_extent = 2*(segment_offsets[it->b.net] + side_sources[1][b]);
+                if (coordinates[1] < extents[b_extent] || coordinates[1] > extents[b_extent + 1]) {
+                    continue;
+                }
+                Intersection file_it = {
+                    .a = { .net = it->a.net, .seg = side_sources[0][a] },
+                    .b = { .net = it->b.net, .seg = side_sources[1][b] },
+                    .point = it->point
+                };
+                IntersectionVec_push(&split, file_it);
+            }
+        }
+    }
+
+    Vec_drop(&sources);
+    Vec_drop(&offsets);
+    Vec_drop(ints);
+    *ints = split;
+}
+
 void check_net_segments(Net* net) {
     size_t segment_count = Vec_len(&net->segments);
     for (size_t i = 0; i < segment_count; i++) {
@@ -214,25 +1365,31 @@ void check_net_segments(Net* net) {
 
         assert((beg->x == end->x) || (beg->y == end->y));
         if ((end->x < beg->x) || (end->y < beg->y)) {
-            mem_swap(&s->beg, &s->end, sizeof(size_t));
+            mem_swap(&s->beg, &s->end, sizeof(index_t));
         }
     }
 }
 
+bool index_fits(uint64_t n) {
+    return (uint64_t)(index_t)n == n;
+}
+
+void check_index_fits(uint64_t n) {
+    if (!index_fits(n)) {
+        SYNTAX_ERROR("index too large, the netlist does not fit COMPACT_INDICES");
+    }
+}
+
 AABB compute_aabb(Vec* nets) {
     // Will crash if there is no point in the first net, seems legit.
     Point first = *(const Point*)Vec_get(&((const Net*)Vec_get(nets, 0))->points, 0);
     AABB aabb = (AABB) { .inf = first, .sup = first };
 
-    size_t net_count = Vec_len(nets);
-    for (size_t n = 0; n < net_count; n++) {
-        const Net* net = Vec_get(nets, n);
-
-        size_t point_count = Vec_len(&net->points);
-        for (size_t p = 0; p < point_count; p++) {
-            const Point* point = Vec_get(&net->points, p);
-
-            AABB_include(&aabb, *point);
+    NetConstSpan net_span = NetVec_span(nets);
+    for (size_t n = 0; n < net_span.len; n++) {
+        PointConstSpan points = PointVec_span(&net_span.data[n].points);
+        for (size_t p = 0; p < points.len; p++) {
+            AABB_include(&aabb, points.data[p]);
         }
     }
 
@@ -252,8 +1409,51 @@ void AABB_include(AABB* aabb, Point p) {
     }
 }
 
+void AABB_include_net(AABB* aabb, bool* has_points, const Net* net) {
+    size_t point_count = Vec_len(&net->points);
+    if (point_count == 0) return;
+
+    if (!*has_points) {
+        Point first = *(const Point*)Vec_get(&net->points, 0);
+        *aabb = (AABB) { .inf = first, .sup = first };
+        *has_points = true;
+    }
+
+    PointConstSpan points = PointVec_span(&net->points);
+    for (size_t p = 0; p < points.len; p++) {
+        AABB_include(aabb, points.data[p]);
+    }
+}
+
 void Netlist_drop(Netlist* nl) {
-    Vec_drop_with(&nl->nets, (void (*)(void*))drop_net);
+    if (nl->mapping.data) {
+        // The nets only borrow their points and segments.
+        Vec_drop(&nl->nets);
+        MappedFile_drop(&nl->mapping);
+    } else if (nl->points.data) {
+        Vec_drop(&nl->nets);
+        Vec_drop(&nl->points);
+        Vec_drop(&nl->segments);
+    } else {
+        Vec_drop_with(&nl->nets, (void (*)(void*))drop_net);
+    }
+    numbering_drop(&nl->numbering);
+    merges_drop(&nl->merges);
+}
+
+void numbering_drop(NetlistNumbering* numbering) {
+    Vec_drop(&numbering->net_ids);
+    Vec_drop(&numbering->net_ranks);
+    Vec_drop(&numbering->segment_ids);
+    Vec_drop(&numbering->segment_ranks);
+}
+
+void merges_drop(NetlistMerges* merges) {
+    Vec_drop(&merges->point_offsets);
+    Vec_drop(&merges->segment_offsets);
+    Vec_drop(&merges->points);
+    Vec_drop(&merges->segments);
+    Vec_drop(&merges->extents);
 }
 
 void drop_net(Net* net) {
@@ -261,6 +1461,54 @@ void drop_net(Net* net) {
     Vec_drop(&net->segments);
 }
 
+void Netlist_to_file(const Netlist* nl, const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        perror("cannot open netlist output file");
+        exit(1);
+    }
+    Writer w = Writer_new(f);
+
+    size_t net_count = Vec_len(&nl->nets);
+    Writer_put_size(&w, net_count);
+    Writer_put_char(&w, '\n');
+
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        size_t point_count = Vec_len(&net->points);
+        size_t segment_count = Vec_len(&net->segments);
+        Writer_put_size(&w, n);
+        Writer_put_char(&w, ' ');
+        Writer_put_size(&w, point_count);
+        Writer_put_char(&w, ' ');
+        Writer_put_size(&w, segment_count);
+        Writer_put_char(&w, '\n');
+
+        for (size_t p = 0; p < point_count; p++) {
+            const Point* point = Vec_get(&net->points, p);
+            Writer_put_str(&w, "  ");
+            Writer_put_size(&w, p);
+            Writer_put_char(&w, ' ');
+            Writer_put_int32(&w, point->x);
+            Writer_put_char(&w, ' ');
+            Writer_put_int32(&w, point->y);
+            Writer_put_char(&w, '\n');
+        }
+
+        for (size_t s = 0; s < segment_count; s++) {
+            const Segment* segment = Vec_get(&net->segments, s);
+            Writer_put_str(&w, "  ");
+            Writer_put_size(&w, segment->beg);
+            Writer_put_char(&w, ' ');
+            Writer_put_size(&w, segment->end);
+            Writer_put_char(&w, '\n');
+        }
+    }
+
+    Writer_drop(&w);
+    fclose(f);
+}
+
 void Netlist_print(const Netlist* nl) {
     size_t net_count = Vec_len(&nl->nets);
     printf("Net count: %zu\n", net_count);
@@ -278,7 +1526,7 @@ void Netlist_print(const Netlist* nl) {
 
         for (size_t s = 0; s < segment_count; s++) {
             const Segment* segment = Vec_get(&net->segments, s);
-            printf("  Segment: %zu %zu\n", segment->beg, segment->end);
+            printf("  Segment: %zu %zu\n", (size_t)segment->beg, (size_t)segment->end);
         }
     }
 }
@@ -286,25 +1534,64 @@ void Netlist_print(const Netlist* nl) {
 size_t Netlist_segment_count(const Netlist* nl) {
     size_t count = 0;
 
-    size_t net_count = Vec_len(&nl->nets);
-    for (size_t n = 0; n < net_count; n++) {
-        const Net* net = Vec_get(&nl->nets, n);
-
-        count += Vec_len(&net->segments);
+    NetConstSpan nets = NetVec_span(&nl->nets);
+    for (size_t n = 0; n < nets.len; n++) {
+        count += Vec_len(&nets.data[n].segments);
     }
 
     return count;
 }
 
-bool segment_intersects(SegmentRef a, SegmentRef b, Point* sect) {
-    if (a.beg->x == a.end->x) { // |
-        if (b.beg->x == b.end->x) { // | & |
+SegmentTable SegmentTable_new(const Netlist* nl) {
+    return segment_table_new_in(nl, NULL);
+}
+
+SegmentTable segment_table_new_in(const Netlist* nl, Allocator* a) {
+    SegmentTable table = Vec_with_capacity_in(Netlist_segment_count(nl),
+                                              sizeof(ResolvedSegment), a);
+
+    NetConstSpan nets = NetVec_span(&nl->nets);
+    for (size_t n = 0; n < nets.len; n++) {
+        const Net* net = &nets.data[n];
+
+        size_t segment_count = Vec_len(&net->segments);
+        for (size_t s = 0; s < segment_count; s++) {
+            ResolvedSegment segment =
+                resolve_net_segment(net, (SegmentLoc) { .net = n, .seg = s });
+            ResolvedSegmentVec_push(&table, segment);
+        }
+    }
+
+    return table;
+}
+
+ResolvedSegment resolve_segment(SegmentLoc loc, Point beg, Point end) {
+    return (ResolvedSegment) {
+        .x0 = beg.x, .y0 = beg.y,
+        .x1 = end.x, .y1 = end.y,
+        .loc = loc,
+        .vertical = (beg.x == end.x)
+    };
+}
+
+ResolvedSegment resolve_net_segment(const Net* net, SegmentLoc loc) {
+    // The segment index may come from an intersection file and the point indices
+    // from the netlist file, they all stay checked.
+    const Segment* segment = Vec_get(&net->segments, loc.seg);
+    const Point* beg = Vec_get(&net->points, segment->beg);
+    const Point* end = Vec_get(&net->points, segment->end);
+    return resolve_segment(loc, *beg, *end);
+}
+
+bool segment_intersects(const ResolvedSegment* a, const ResolvedSegment* b, Point* sect) {
+    if (a->vertical) { // |
+        if (b->vertical) { // | & |
             return false;
        } else { // | & -
             return hv_intersects(b, a, sect);
        }
     } else { // -
-        if (b.beg->y == b.end->y) { // - & -
+        if (b->y0 == b->y1) { // - & -
             return false;
         } else { // - & |
             return hv_intersects(a, b, sect);
@@ -312,12 +1599,12 @@ bool segment_intersects(SegmentRef a, SegmentRef b, Point* sect) {
     }
 }
 
-bool hv_intersects(SegmentRef h, SegmentRef v, Point* sect) {
-    if (h.beg->x <= v.beg->x && v.beg->x <= h.end->x &&
-        v.beg->y <= h.beg->y && h.beg->y <= v.end->y) {
+bool hv_intersects(const ResolvedSegment* h, const ResolvedSegment* v, Point* sect) {
+    if (h->x0 <= v->x0 && v->x0 <= h->x1 &&
+        v->y0 <= h->y0 && h->y0 <= v->y1) {
 
-        sect->x = v.beg->x;
-        sect->y = h.beg->y;
+        sect->x = v->x0;
+        sect->y = h->y0;
         return true;
     }
     return false;
@@ -325,214 +1612,459 @@ bool hv_intersects(SegmentRef h, SegmentRef v, Point* sect) {
 
 IntersectionVec Netlist_intersections_naive(const Netlist* nl) {
     IntersectionVec intersections = Vec_new(sizeof(Intersection));
+    SegmentTable table = SegmentTable_new(nl);
+    ResolvedSegmentConstSpan segments = ResolvedSegmentVec_span(&table);
+
+    // Every vertical segment is tested against all the horizontal ones,
+    // identified by their index in the table.
+    CrossingSet horizontals = CrossingSet_new();
+    for (size_t i = 0; i < segments.len; i++) {
+        const ResolvedSegment* d = &segments.data[i];
+        if (!d->vertical) {
+            CrossingSet_push(&horizontals, d->y0, d->x0, d->x1, crossing_net(d->loc.net), i);
+        }
+    }
 
-    size_t net_count = Vec_len(&nl->nets);
-    for (size_t i = 0; i < net_count; i++) {
-        const Net* a_net = Vec_get(&nl->nets, i);
-
-        size_t a_segment_count = Vec_len(&a_net->segments);
-        for (size_t s = 0; s < a_segment_count; s++) {
-            const Segment* a = Vec_get(&a_net->segments, s);
-            SegmentRef a_ref = {
-                .beg = Vec_get(&a_net->points, a->beg),
-                .end = Vec_get(&a_net->points, a->end)
+    Vec found = Vec_new(sizeof(size_t));
+    for (size_t i = 0; i < segments.len; i++) {
+        const ResolvedSegment* vd = &segments.data[i];
+        if (!vd->vertical) {
+            continue;
+        }
+
+        Vec_clear(&found);
+        CrossingSet_find(&horizontals, vd->x0, vd->y0, vd->y1, crossing_net(vd->loc.net), &found);
+        const size_t* ids = found.data;
+        for (size_t k = 0; k < Vec_len(&found); k++) {
+            size_t j = ids[k];
+            const ResolvedSegment* hd = &segments.data[j];
+            // The segment of the first net in the table comes first.
+            Intersection intersection = {
+                .a = i < j ? vd->loc : hd->loc,
+                .b = i < j ? hd->loc : vd->loc,
+                .point = { vd->x0, hd->y0 }
             };
+            IntersectionVec_push(&intersections, intersection);
+        }
+    }
 
-            // Internet intersections
-            for (size_t j = i + 1; j < net_count; j++) {
-                const Net* b_net = Vec_get(&nl->nets, j);
-
-                size_t b_segment_count = Vec_len(&b_net->segments);
-                for (size_t t = 0; t < b_segment_count; t++) {
-                    const Segment* b = Vec_get(&b_net->segments, t);
-                    SegmentRef b_ref = {
-                        .beg = Vec_get(&b_net->points, b->beg),
-                        .end = Vec_get(&b_net->points, b->end)
-                    };
-
-                    Point section;
-                    if (segment_intersects(a_ref, b_ref, &section)) {
-                        Intersection intersection = {
-                            .a = { .net = i, .seg = s },
-                            .b = { .net = j, .seg = t },
-                            .point = section
-                        };
-                        Vec_push(&intersections, &intersection);
-                    }
-                }
+    Vec_drop(&found);
+    CrossingSet_drop(&horizontals);
+    Vec_drop(&table);
+
+    return intersections;
+}
+
+IntersectionVec Netlist_intersections_parallel_naive(const Netlist* nl) {
+    SegmentTable table = SegmentTable_new(nl);
+    ResolvedSegmentConstSpan segments = ResolvedSegmentVec_span(&table);
+    size_t net_count = Vec_len(&nl->nets);
+
+    // The table is ordered by net, and so are the sets: the segments of the nets
+    // after a net are the end of the sets.
+    CrossingSet horizontals = CrossingSet_new();
+    CrossingSet verticals = CrossingSet_new();
+    Vec h_offsets = Vec_with_capacity(net_count + 1, sizeof(size_t));
+    Vec v_offsets = Vec_with_capacity(net_count + 1, sizeof(size_t));
+    size_t i = 0;
+    for (size_t n = 0; n <= net_count; n++) {
+        size_t h_count = CrossingSet_len(&horizontals);
+        size_t v_count = CrossingSet_len(&verticals);
+        Vec_push(&h_offsets, &h_count);
+        Vec_push(&v_offsets, &v_count);
+
+        for (; i < segments.len && segments.data[i].loc.net == n; i++) {
+            const ResolvedSegment* d = &segments.data[i];
+            uint32_t net = crossing_net(d->loc.net);
+            if (d->vertical) {
+                CrossingSet_push(&verticals, d->x0, d->y0, d->y1, net, i);
+            } else {
+                CrossingSet_push(&horizontals, d->y0, d->x0, d->x1, net, i);
             }
         }
     }
 
+    ParallelNaive pn = {
+        .table = &table,
+        .horizontals = &horizontals,
+        .verticals = &verticals,
+        .h_offsets = &h_offsets,
+        .v_offsets = &v_offsets
+    };
+
+    // Many chunks per thread let the threads which are done early take the next ones.
+    size_t thread_count = cpu_count();
+    Vec chunks = split_naive_chunks(&pn, 16*thread_count);
+    size_t chunk_count = Vec_len(&chunks) - 1;
+
+    Vec results = Vec_with_capacity(chunk_count, sizeof(IntersectionVec));
+    for (size_t c = 0; c < chunk_count; c++) {
+        IntersectionVec chunk_intersections = Vec_new(sizeof(Intersection));
+        Vec_push(&results, &chunk_intersections);
+    }
+    pn.chunks = &chunks;
+    pn.results = &results;
+    parallel_for(chunk_count, thread_count, (void (*)(void*, size_t))naive_chunk, &pn);
+
+    IntersectionVec intersections = gather_intersections(&results);
+
+    Vec_drop(&chunks);
+    Vec_drop(&v_offsets);
+    Vec_drop(&h_offsets);
+    CrossingSet_drop(&verticals);
+    CrossingSet_drop(&horizontals);
+    Vec_drop(&table);
+
     return intersections;
 }
 
+size_t naive_weight(const ParallelNaive* pn, const ResolvedSegment* d) {
+    // A segment is tested against the segments of the other direction in the nets after its own.
+    size_t n = (size_t)d->loc.net + 1;
+    if (d->vertical) {
+        return 1 + CrossingSet_len(pn->horizontals) - *(const size_t*)Vec_get(pn->h_offsets, n);
+    } else {
+        return 1 + CrossingSet_len(pn->verticals) - *(const size_t*)Vec_get(pn->v_offsets, n);
+    }
+}
+
+Vec split_naive_chunks(const ParallelNaive* pn, size_t chunk_count) {
+    // The pairs of segments of the nets `i < j` make a triangle, which is cut
+    // in runs of segments holding about as many pairs.
+    ResolvedSegmentConstSpan segments = ResolvedSegmentVec_span(pn->table);
+    uint64_t total = 0;
+    for (size_t s = 0; s < segments.len; s++) {
+        total += naive_weight(pn, &segments.data[s]);
+    }
+
+    Vec chunks = Vec_with_capacity(chunk_count + 1, sizeof(size_t));
+    size_t bound = 0;
+    Vec_push(&chunks, &bound);
+    uint64_t done = 0;
+    size_t next_cut = 1;
+    for (size_t s = 0; s < segments.len; s++) {
+        done += naive_weight(pn, &segments.data[s]);
+        if (next_cut < chunk_count && done*chunk_count >= next_cut*total) {
+            while (next_cut < chunk_count && done*chunk_count >= next_cut*total) {
+                next_cut++;
+            }
+            bound = s + 1;
+            Vec_push(&chunks, &bound);
+        }
+    }
+    if (bound < segments.len || Vec_len(&chunks) == 1) {
+        bound = segments.len;
+        Vec_push(&chunks, &bound);
+    }
+
+    return chunks;
+}
+
+void naive_chunk(ParallelNaive* pn, size_t i) {
+    size_t first = *(const size_t*)Vec_get(pn->chunks, i);
+    size_t last = *(const size_t*)Vec_get(pn->chunks, i + 1);
+    IntersectionVec* intersections = Vec_get_mut(pn->results, i);
+    ResolvedSegmentConstSpan segments = ResolvedSegmentVec_span(pn->table);
+
+    Vec found = Vec_new(sizeof(size_t));
+    for (size_t s = first; s < last; s++) {
+        const ResolvedSegment* d = &segments.data[s];
+        size_t n = (size_t)d->loc.net + 1;
+        uint32_t net = crossing_net(d->loc.net);
+
+        Vec_clear(&found);
+        if (d->vertical) {
+            CrossingSet_find_from(pn->horizontals, *(const size_t*)Vec_get(pn->h_offsets, n),
+                                  d->x0, d->y0, d->y1, net, &found);
+        } else {
+            CrossingSet_find_from(pn->verticals, *(const size_t*)Vec_get(pn->v_offsets, n),
+                                  d->y0, d->x0, d->x1, net, &found);
+        }
+
+        // The segment of the first net in the table comes first, as in the serial engine.
+        const size_t* ids = found.data;
+        for (size_t k = 0; k < Vec_len(&found); k++) {
+            const ResolvedSegment* other = &segments.data[ids[k]];
+            const ResolvedSegment* vd = d->vertical ? d : other;
+            const ResolvedSegment* hd = d->vertical ? other : d;
+            Intersection intersection = {
+                .a = d->loc,
+                .b = other->loc,
+                .point = { vd->x0, hd->y0 }
+            };
+            IntersectionVec_push(intersections, intersection);
+        }
+    }
+    Vec_drop(&found);
+}
+
 
 IntersectionVec Netlist_intersections_vec_sweep(const Netlist* nl) {
-    BinaryHeap breakpoints = sweep_init(nl);
+    Sweep sweep = sweep_init(nl, NULL);
     IntersectionVec intersections = Vec_new(sizeof(Intersection));
-    Vec segments = Vec_new(sizeof(BreakpointData));
+    // The active segments are identified by their index in the sweep table.
+    CrossingSet segments = CrossingSet_new();
+    Vec found = Vec_new(sizeof(size_t));
 
-    Breakpoint breakpoint;
-    while (BinaryHeap_pop(&breakpoints, &breakpoint)) {
-        switch (breakpoint.type) {
+    BreakpointType type;
+    ResolvedSegment* segment;
+    sweep_start(&sweep);
+    while (sweep_next(&sweep, &type, &segment)) {
+        size_t id = (size_t)(segment - (ResolvedSegment*)sweep.segments.data);
+        switch (type) {
             case H_SEGMENT_BEGIN:
-                vec_sweep_comes_across(&segments, &breakpoint.data);
+                vec_sweep_comes_across(&segments, segment, id);
                 break;
             case H_SEGMENT_END:
-                vec_sweep_goes_past(&segments, &breakpoint.data);
+                vec_sweep_goes_past(&segments, id);
                 break;
             case V_SEGMENT:
-                vec_sweep_check_intersections(&intersections, &segments,
-                                              &breakpoint.data);
+                vec_sweep_check_intersections(&intersections, &segments, &sweep.segments,
+                                              segment, &found);
                 break;
         }
     }
 
-    Vec_drop(&segments);
-    BinaryHeap_drop(&breakpoints);
+    Vec_drop(&found);
+    CrossingSet_drop(&segments);
+    sweep_drop(&sweep);
 
     return intersections;
 }
 
-BinaryHeap sweep_init(const Netlist* nl) {
-    BinaryHeap breakpoints = BinaryHeap_new(sizeof(Breakpoint),
-        (bool (*)(const void*, const void*))sweep_order);
+Sweep sweep_new() {
+    return (Sweep) {
+        .segments = Vec_new(sizeof(ResolvedSegment)),
+        .breakpoints = Vec_new(sizeof(uint64_t)),
+        .next = 0,
+        .end = 0,
+        .use_heap = false,
+        .heap = BinaryHeap_new(sizeof(uint64_t),
+            (bool (*)(const void*, const void*))breakpoint_key_order)
+    };
+}
 
-    size_t net_count = Vec_len(&nl->nets);
-    for (size_t n = 0; n < net_count; n++) {
-        const Net* net = Vec_get(&nl->nets, n);
+Sweep sweep_init(const Netlist* nl, Allocator* a) {
+    SegmentTable segments = segment_table_new_in(nl, a);
+    size_t segment_count = Vec_len(&segments);
+    Sweep sweep = {
+        .segments = segments,
+        // At most two breakpoints per segment, one for the vertical ones.
+        .breakpoints = Vec_with_capacity_in(2*segment_count, sizeof(uint64_t), a),
+        .next = 0,
+        .end = 0,
+        .use_heap = false,
+        .heap = BinaryHeap_new_in(sizeof(uint64_t),
+            (bool (*)(const void*, const void*))breakpoint_key_order, a)
+    };
 
-        size_t segment_count = Vec_len(&net->segments);
-        for (size_t s = 0; s < segment_count; s++) {
-            const Segment* segment = Vec_get(&net->segments, s);
+    for (size_t i = 0; i < segment_count; i++) {
+        sweep_push_breakpoints(&sweep, i);
+    }
 
-            sweep_memorize(&breakpoints, (SegmentLoc) { .net = n, .seg = s },
-                           net, segment);
-        }
+    return sweep;
+}
+
+Sweep sweep_init_from_scanner(Scanner* s) {
+    Sweep sweep = sweep_new();
+
+    size_t net_count;
+    if (!Scanner_size(s, &net_count)) {
+        SYNTAX_ERROR("expected net count on first line");
+    }
+    check_index_fits(net_count);
+    Scanner_skip_line(s);
+
+    // Only the points of the current net are kept around.
+    Vec points = Vec_new(sizeof(Point));
+    for (size_t n = 0; n < net_count; n++) {
+        sweep_memorize_net(&sweep, n, s, &points);
     }
+    Vec_drop(&points);
 
-    return breakpoints;
+    return sweep;
 }
 
-bool sweep_order(const Breakpoint* a, const Breakpoint* b) {
-    int32_t x_a = Breakpoint_get_x(a);
-    int32_t x_b = Breakpoint_get_x(b);
+void sweep_memorize_net(Sweep* sw, size_t n, Scanner* s, Vec* points) {
+    int64_t v[3];
+    if (!read_integers(s, v, 3) || v[0] < 0 || v[1] < 0 || v[2] < 0) {
+        SYNTAX_ERROR("expected `net_number point_count segment_count` net description");
+    }
+    size_t point_count = (size_t)v[1];
+    size_t segment_count = (size_t)v[2];
+    check_index_fits(segment_count);
+
+    Vec_clear(points);
+    Vec_reserve(points, point_count);
+    for (size_t i = 0; i < point_count; i++) {
+        point_from_scanner(points, s);
+    }
 
-    if (x_a == x_b) {
-        BreakpointType t_a = a->type;
-        BreakpointType t_b = b->type;
+    for (size_t i = 0; i < segment_count; i++) {
+        if (!read_integers(s, v, 2) || v[0] < 0 || v[1] < 0) {
+            SYNTAX_ERROR("expected `segment_begin segment_end` segment description");
+        }
+        Point beg = *(const Point*)Vec_get(points, (size_t)v[0]);
+        Point end = *(const Point*)Vec_get(points, (size_t)v[1]);
 
-        if (t_a == V_SEGMENT) {
-            return t_b == H_SEGMENT_END;
-        } else if (t_a == H_SEGMENT_BEGIN) {
-            return t_b == V_SEGMENT;
+        // Same checks as `check_net_segments`.
+        assert((beg.x == end.x) || (beg.y == end.y));
+        if ((end.x < beg.x) || (end.y < beg.y)) {
+            mem_swap(&beg, &end, sizeof(Point));
         }
 
-        return false;
+        sweep_memorize(sw, (SegmentLoc) { .net = n, .seg = i }, beg, end);
     }
+}
 
-    return x_a < x_b;
+uint64_t breakpoint_key(int32_t x, BreakpointType type, size_t segment) {
+    return ((uint64_t)((uint32_t)x ^ 0x80000000u) << 32) |
+           ((uint64_t)type << BREAKPOINT_SEGMENT_BITS) | (uint64_t)segment;
 }
 
-int32_t Breakpoint_get_x(const Breakpoint* b) {
-    BreakpointType t = b->type;
-    if (t == H_SEGMENT_BEGIN) {
-        return b->data.ref.beg->x;
-    } else {
-        return b->data.ref.end->x;
-    }
+bool breakpoint_key_order(const uint64_t* a, const uint64_t* b) {
+    return *a < *b;
 }
 
-void sweep_memorize(BinaryHeap* bh, SegmentLoc sl,
-                    const Net* net, const Segment* segment) {
-    const Point* beg = Vec_get(&net->points, segment->beg);
-    const Point* end = Vec_get(&net->points, segment->end);
-    BreakpointData data = { .loc = sl, { .beg = beg, .end = end } };
+int32_t breakpoint_x(uint64_t key) {
+    return (int32_t)((uint32_t)(key >> 32) ^ 0x80000000u);
+}
+
+void sweep_memorize(Sweep* sw, SegmentLoc sl, Point beg, Point end) {
+    ResolvedSegment segment = resolve_segment(sl, beg, end);
+    ResolvedSegmentVec_push(&sw->segments, segment);
+    sweep_push_breakpoints(sw, Vec_len(&sw->segments) - 1);
+}
 
-    if (beg->x == end->x) { // |
-        Breakpoint breakpoint = { .type = V_SEGMENT, .data = data };
-        BinaryHeap_push(bh, &breakpoint);
+void sweep_push_breakpoints(Sweep* sw, size_t i) {
+    if (i >> BREAKPOINT_SEGMENT_BITS) {
+        perror("too many segments for the sweep breakpoints");
+        exit(1);
+    }
+    const ResolvedSegment* segment = ResolvedSegmentVec_at(&sw->segments, i);
+
+    if (segment->vertical) { // |
+        uint64_t key = breakpoint_key(segment->x0, V_SEGMENT, i);
+        Vec_push(&sw->breakpoints, &key);
     } else { // -
-        Breakpoint breakpoint = { .type = H_SEGMENT_BEGIN, .data = data };
-        BinaryHeap_push(bh, &breakpoint);
-        breakpoint.type = H_SEGMENT_END;
-        BinaryHeap_push(bh, &breakpoint);
+        uint64_t key = breakpoint_key(segment->x0, H_SEGMENT_BEGIN, i);
+        Vec_push(&sw->breakpoints, &key);
+        key = breakpoint_key(segment->x1, H_SEGMENT_END, i);
+        Vec_push(&sw->breakpoints, &key);
     }
 }
 
-void vec_sweep_comes_across(Vec* segments, BreakpointData* d) {
-    Vec_push(segments, d);
+void sweep_start(Sweep* sw) {
+    size_t count = Vec_len(&sw->breakpoints);
+    uint64_t* keys = sw->breakpoints.data;
+    if (sw->use_heap) {
+        for (size_t i = 0; i < count; i++) {
+            BinaryHeap_push(&sw->heap, &keys[i]);
+        }
+    } else {
+        radix_sort_u64(keys, count, sw->breakpoints.allocator);
+    }
+    sw->next = 0;
+    sw->end = count;
 }
 
-void vec_sweep_goes_past(Vec* segments, const BreakpointData* d) {
-    size_t seg_count = Vec_len(segments);
-    for (size_t i = 0; i < seg_count; i++) {
-        const BreakpointData* d_i = Vec_get(segments, i);
-
-        if (memcmp(&d->loc, &d_i->loc, sizeof(SegmentLoc)) == 0) {
-            Vec_swap_remove(segments, i, NULL);
-            return;
+bool sweep_next(Sweep* sw, BreakpointType* type, ResolvedSegment** segment) {
+    uint64_t key;
+    if (sw->use_heap) {
+        if (!BinaryHeap_pop(&sw->heap, &key)) {
+            return false;
+        }
+    } else {
+        if (sw->next == sw->end) {
+            return false;
         }
+        key = ((const uint64_t*)sw->breakpoints.data)[sw->next++];
     }
+
+    // The table does not grow during the sweep, the segment stays put.
+    const uint64_t segment_mask = ((uint64_t)1 << BREAKPOINT_SEGMENT_BITS) - 1;
+    *type = (BreakpointType)((key >> BREAKPOINT_SEGMENT_BITS) & 3);
+    *segment = ResolvedSegmentVec_at_mut(&sw->segments, (size_t)(key & segment_mask));
+    return true;
 }
 
-void vec_sweep_check_intersections(IntersectionVec* intersections,
-                               const Vec* segments, const BreakpointData* vd) {
-    size_t seg_count = Vec_len(segments);
-    for (size_t i = 0; i < seg_count; i++) {
-        const BreakpointData* hd = Vec_get(segments, i);
-        int32_t hy = hd->ref.beg->y;
+void sweep_drop(Sweep* sw) {
+    Vec_drop(&sw->segments);
+    Vec_drop(&sw->breakpoints);
+    BinaryHeap_drop(&sw->heap);
+}
 
-        if (hd->loc.net != vd->loc.net) {
-            if (vd->ref.beg->y <= hy && hy <= vd->ref.end->y) {
-                Intersection intersection = {
-                    .a = vd->loc, .b = hd->loc,
-                    .point = { vd->ref.beg->x, hy }
-                };
-                Vec_push(intersections, &intersection);
-            }
-        }
+uint32_t crossing_net(index_t net) {
+    if ((uint32_t)net != net) {
+        perror("too many nets for the crossing tests");
+        exit(1);
+    }
+    return (uint32_t)net;
+}
+
+void vec_sweep_comes_across(CrossingSet* segments, const ResolvedSegment* d, size_t id) {
+    CrossingSet_push(segments, d->y0, d->x0, d->x1, crossing_net(d->loc.net), id);
+}
+
+void vec_sweep_goes_past(CrossingSet* segments, size_t id) {
+    CrossingSet_remove(segments, id);
+}
+
+void vec_sweep_check_intersections(IntersectionVec* intersections, const CrossingSet* segments,
+                                   const Vec* table, const ResolvedSegment* vd, Vec* found) {
+    Vec_clear(found);
+    // The active segments all span the sweep x, only their y is left to test.
+    CrossingSet_find(segments, vd->x0, vd->y0, vd->y1, crossing_net(vd->loc.net), found);
+
+    const size_t* ids = found->data;
+    for (size_t k = 0; k < Vec_len(found); k++) {
+        const ResolvedSegment* hd = ResolvedSegmentVec_at(table, ids[k]);
+        Intersection intersection = {
+            .a = vd->loc, .b = hd->loc,
+            .point = { vd->x0, hd->y0 }
+        };
+        IntersectionVec_push(intersections, intersection);
     }
 }
 
 
 IntersectionVec Netlist_intersections_list_sweep(const Netlist* nl) {
-    BinaryHeap breakpoints = sweep_init(nl);
+    Sweep sweep = sweep_init(nl, NULL);
     IntersectionVec intersections = Vec_new(sizeof(Intersection));
-    List segments = List_new(sizeof(BreakpointData));
+    List segments = List_new(sizeof(ResolvedSegment));
 
-    Breakpoint breakpoint;
-    while (BinaryHeap_pop(&breakpoints, &breakpoint)) {
-        switch (breakpoint.type) {
+    BreakpointType type;
+    ResolvedSegment* segment;
+    sweep_start(&sweep);
+    while (sweep_next(&sweep, &type, &segment)) {
+        switch (type) {
             case H_SEGMENT_BEGIN:
-                list_sweep_comes_across(&segments, &breakpoint.data);
+                list_sweep_comes_across(&segments, segment);
                 break;
             case H_SEGMENT_END:
-                list_sweep_goes_past(&segments, &breakpoint.data);
+                list_sweep_goes_past(&segments, segment);
                 break;
             case V_SEGMENT:
-                list_sweep_check_intersections(&intersections, &segments,
-                                               &breakpoint.data);
+                list_sweep_check_intersections(&intersections, &segments, segment);
                 break;
         }
     }
 
     List_clear(&segments);
-    BinaryHeap_drop(&breakpoints);
+    sweep_drop(&sweep);
 
     return intersections;
 }
 
-void list_sweep_comes_across(List* segments, BreakpointData* d) {
-    int32_t y = d->ref.beg->y;
+void list_sweep_comes_across(List* segments, ResolvedSegment* d) {
+    int32_t y = d->y0;
 
     ListNode* n = List_front_node_mut(segments);
     if (!n) {
         List_push(segments, d);
     } else {
-        const BreakpointData* nd = ListNode_elem(n);
-        int32_t ny = nd->ref.beg->y;
+        const ResolvedSegment* nd = ListNode_elem(n);
+        int32_t ny = nd->y0;
 
         if (y <= ny) {
             List_push(segments, d);
@@ -542,7 +2074,7 @@ void list_sweep_comes_across(List* segments, BreakpointData* d) {
 
             while (n) {
                 nd = ListNode_elem(n);
-                ny = nd->ref.beg->y;
+                ny = nd->y0;
                 if (y <= ny) {
                     break;
                 }
@@ -556,10 +2088,10 @@ void list_sweep_comes_across(List* segments, BreakpointData* d) {
     }
 }
 
-void list_sweep_goes_past(List* segments, const BreakpointData* d) {
+void list_sweep_goes_past(List* segments, const ResolvedSegment* d) {
     ListNode* n = List_front_node_mut(segments);
     if (n) {
-        const BreakpointData* nd = ListNode_elem(n);
+        const ResolvedSegment* nd = ListNode_elem(n);
 
         if (memcmp(&nd->loc, &d->loc, sizeof(SegmentLoc)) == 0) {
             List_pop(segments, NULL);
@@ -582,70 +2114,295 @@ void list_sweep_goes_past(List* segments, const BreakpointData* d) {
 }
 
 void list_sweep_check_intersections(IntersectionVec* intersections,
-                                    const List* segments, const BreakpointData* vd) {
-    int32_t y_min = vd->ref.beg->y;
-    int32_t y_max = vd->ref.end->y;
+                                    const List* segments, const ResolvedSegment* vd) {
+    int32_t y_min = vd->y0;
+    int32_t y_max = vd->y1;
 
     const ListNode* n = List_front_node(segments);
 
     while (n) {
-        const BreakpointData* hd = ListNode_elem(n);
-        int32_t hy = hd->ref.beg->y;
+        const ResolvedSegment* hd = ListNode_elem(n);
+        int32_t hy = hd->y0;
+
+        if (hy >= y_min) break;
+
+        n = ListNode_next(n);
+    }
+
+    while (n) {
+        const ResolvedSegment* hd = ListNode_elem(n);
+        int32_t hy = hd->y0;
+
+        if (hy > y_max) break;
+
+        if (hd->loc.net != vd->loc.net) {
+            Intersection intersection = {
+                .a = vd->loc, .b = hd->loc,
+                .point = { vd->x0, hy }
+            };
+            IntersectionVec_push(intersections, intersection);
+        }
+
+        n = ListNode_next(n);
+    }
+}
+
+IntersectionVec Netlist_intersections_avl_sweep(const Netlist* nl) {
+    return Netlist_intersections_avl_sweep_in(nl, NULL);
+}
+
+IntersectionVec Netlist_intersections_avl_sweep_in(const Netlist* nl, Allocator* a) {
+    Sweep sweep = sweep_init(nl, a);
+    return avl_sweep(&sweep, a);
+}
+
+IntersectionVec Netlist_intersections_avl_heap_sweep(const Netlist* nl) {
+    Sweep sweep = sweep_init(nl, NULL);
+    sweep.use_heap = true;
+    return avl_sweep(&sweep, NULL);
+}
+
+IntersectionVec Netlist_file_intersections_avl_sweep(const char* path) {
+    MappedFile mf = MappedFile_open(path);
+    if (is_binary_netlist(mf.data, mf.len) || is_compressed_netlist(mf.data, mf.len)) {
+        // The binary nets are borrowed from the mapping, nothing to build,
+        // and compressed nets are decoded faster than the text can be parsed.
+        MappedFile_drop(&mf);
+        Netlist nl = Netlist_from_file(path);
+        IntersectionVec intersections = Netlist_intersections_avl_sweep(&nl);
+        Netlist_drop(&nl);
+        return intersections;
+    }
+
+    Scanner s = Scanner_new(mf.data, mf.len);
+    Sweep sweep = sweep_init_from_scanner(&s);
+    MappedFile_drop(&mf);
+
+    return avl_sweep(&sweep, NULL);
+}
+
+IntersectionVec Netlist_intersections_between(const Netlist* a, Vector a_offset,
+                                              const Netlist* b, Vector b_offset,
+                                              AABB region) {
+    Sweep sweep = sweep_new();
+
+    // The nets of `b` come after the nets of `a` during the sweep.
+    size_t a_net_count = Vec_len(&a->nets);
+    sweep_memorize_translated(&sweep, a, a_offset, region, 0);
+    sweep_memorize_translated(&sweep, b, b_offset, region, a_net_count);
+    IntersectionVec swept = avl_sweep(&sweep, NULL);
+
+    IntersectionVec intersections = Vec_new(sizeof(Intersection));
+    size_t swept_count = Vec_len(&swept);
+    for (size_t i = 0; i < swept_count; i++) {
+        Intersection inter = *(const Intersection*)Vec_get(&swept, i);
+        bool a_in_a = inter.a.net < a_net_count;
+        bool b_in_a = inter.b.net < a_net_count;
+        if (a_in_a == b_in_a) continue;
+
+        if (!a_in_a) {
+            mem_swap(&inter.a, &inter.b, sizeof(SegmentLoc));
+        }
+        inter.b.net -= a_net_count;
+        Vec_push(&intersections, &inter);
+    }
+    Vec_drop(&swept);
+
+    return intersections;
+}
+
+void sweep_memorize_translated(Sweep* sw, const Netlist* nl, Vector offset,
+                               AABB region, size_t first_net) {
+    NetConstSpan nets = NetVec_span(&nl->nets);
+    for (size_t n = 0; n < nets.len; n++) {
+        const Net* net = &nets.data[n];
+
+        SegmentConstSpan segments = SegmentVec_span(&net->segments);
+        for (size_t s = 0; s < segments.len; s++) {
+            const Segment* segment = &segments.data[s];
+            Point beg = *(const Point*)Vec_get(&net->points, segment->beg);
+            Point end = *(const Point*)Vec_get(&net->points, segment->end);
+            beg.x += offset.x; beg.y += offset.y;
+            end.x += offset.x; end.y += offset.y;
+
+            // Segments are ordered, `beg` is their lower corner.
+            if (end.x < region.inf.x || region.sup.x < beg.x ||
+                end.y < region.inf.y || region.sup.y < beg.y) continue;
+
+            sweep_memorize(sw, (SegmentLoc) { .net = first_net + n, .seg = s }, beg, end);
+        }
+    }
+}
+
+IntersectionVec avl_sweep(Sweep* sw, Allocator* a) {
+    IntersectionVec intersections = Vec_new_in(sizeof(Intersection), a);
+    AVLTree segments = AVLTree_new_in(sizeof(ResolvedSegment),
+                                      (int8_t (*)(const void*, const void*))compare, a);
+
+    sweep_start(sw);
+    avl_sweep_run(sw, &segments, &intersections);
+
+    AVLTree_clear(&segments);
+    sweep_drop(sw);
+
+    return intersections;
+}
+
+void avl_sweep_run(Sweep* sw, AVLTree* segments, IntersectionVec* intersections) {
+    BreakpointType type;
+    ResolvedSegment* segment;
+    while (sweep_next(sw, &type, &segment)) {
+        switch (type) {
+            case H_SEGMENT_BEGIN:
+                avl_sweep_comes_across(segments, segment);
+                break;
+            case H_SEGMENT_END:
+                avl_sweep_goes_past(segments, segment);
+                break;
+            case V_SEGMENT:
+                avl_sweep_check_intersections(intersections, segments, segment);
+                break;
+        }
+    }
+}
+
+IntersectionVec Netlist_intersections_parallel_sweep(const Netlist* nl) {
+    Sweep sweep = sweep_init(nl, NULL);
+    sweep_start(&sweep);
+
+    // A few strips per thread keep the threads busy when the strips differ.
+    size_t thread_count = cpu_count();
+    Vec strips = split_sweep_strips(&sweep, 4*thread_count);
+    size_t strip_count = Vec_len(&strips);
+    Vec seeds = sweep_strip_seeds(&sweep, &strips);
+
+    Vec results = Vec_with_capacity(strip_count, sizeof(IntersectionVec));
+    for (size_t i = 0; i < strip_count; i++) {
+        IntersectionVec strip_intersections = Vec_new(sizeof(Intersection));
+        Vec_push(&results, &strip_intersections);
+    }
+    ParallelSweep ps = {
+        .sweep = &sweep,
+        .strips = &strips,
+        .seeds = &seeds,
+        .results = &results
+    };
+    parallel_for(strip_count, thread_count, (void (*)(void*, size_t))sweep_strip, &ps);
+
+    IntersectionVec intersections = gather_intersections(&results);
+
+    for (size_t i = 0; i < strip_count; i++) {
+        Vec_drop(Vec_get_mut(&seeds, i));
+    }
+    Vec_drop(&seeds);
+    Vec_drop(&strips);
+    sweep_drop(&sweep);
+
+    return intersections;
+}
+
+IntersectionVec gather_intersections(Vec* results) {
+    // The intersections of every task are concatenated in task order, and released.
+    size_t result_count = Vec_len(results);
+    size_t total = 0;
+    for (size_t i = 0; i < result_count; i++) {
+        total += Vec_len((const IntersectionVec*)Vec_get(results, i));
+    }
+    IntersectionVec intersections = Vec_with_capacity(total, sizeof(Intersection));
+    for (size_t i = 0; i < result_count; i++) {
+        IntersectionVec* task_intersections = Vec_get_mut(results, i);
+        size_t count = Vec_len(task_intersections);
+        if (count > 0) {
+            memcpy(Vec_unsafe_get_mut(&intersections, Vec_len(&intersections)),
+                   task_intersections->data, count*sizeof(Intersection));
+            intersections.len += count;
+        }
+        Vec_drop(task_intersections);
+    }
+    Vec_drop(results);
 
-        if (hy >= y_min) break;
+    return intersections;
+}
 
-        n = ListNode_next(n);
+Vec split_sweep_strips(const Sweep* sw, size_t strip_count) {
+    // The strips hold about as many breakpoints, but never cut the ones of a same x.
+    size_t count = Vec_len(&sw->breakpoints);
+    const uint64_t* keys = sw->breakpoints.data;
+    Vec strips = Vec_with_capacity(strip_count, sizeof(SweepStrip));
+
+    size_t first = 0;
+    for (size_t k = 1; k <= strip_count && first < count; k++) {
+        size_t last = (k == strip_count) ? count : size_t_max(first + 1, k*count/strip_count);
+        while (last < count && breakpoint_x(keys[last]) == breakpoint_x(keys[last - 1])) {
+            last++;
+        }
+        SweepStrip strip = { .first = first, .last = last, .x = breakpoint_x(keys[first]) };
+        Vec_push(&strips, &strip);
+        first = last;
     }
 
-    while (n) {
-        const BreakpointData* hd = ListNode_elem(n);
-        int32_t hy = hd->ref.beg->y;
+    return strips;
+}
 
-        if (hy > y_max) break;
+Vec sweep_strip_seeds(const Sweep* sw, const Vec* strips) {
+    size_t strip_count = Vec_len(strips);
+    const SweepStrip* strip = strips->data;
+    Vec seeds = Vec_with_capacity(strip_count, sizeof(Vec));
+    for (size_t i = 0; i < strip_count; i++) {
+        Vec strip_seeds = Vec_new(sizeof(size_t));
+        Vec_push(&seeds, &strip_seeds);
+    }
 
-        if (hd->loc.net != vd->loc.net) {
-            Intersection intersection = {
-                .a = vd->loc, .b = hd->loc,
-                .point = { vd->ref.beg->x, hy }
-            };
-            Vec_push(intersections, &intersection);
+    // A horizontal segment seeds the strips whose left edge is in `(x0, x1]`,
+    // the first one is found by a binary search over the increasing edges.
+    ResolvedSegmentConstSpan table = ResolvedSegmentVec_span(&sw->segments);
+    for (size_t s = 0; s < table.len; s++) {
+        const ResolvedSegment* d = &table.data[s];
+        if (d->vertical) continue;
+
+        size_t lo = 0;
+        size_t hi = strip_count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo)/2;
+            if (strip[mid].x <= d->x0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (size_t i = lo; i < strip_count && strip[i].x <= d->x1; i++) {
+            Vec_push(Vec_get_mut(&seeds, i), &s);
         }
-
-        n = ListNode_next(n);
     }
+
+    return seeds;
 }
 
-IntersectionVec Netlist_intersections_avl_sweep(const Netlist* nl) {
-    BinaryHeap breakpoints = sweep_init(nl);
-    IntersectionVec intersections = Vec_new(sizeof(Intersection));
-    AVLTree segments = AVLTree_new(sizeof(BreakpointData),
+void sweep_strip(ParallelSweep* ps, size_t i) {
+    const SweepStrip* strip = Vec_get(ps->strips, i);
+    AVLTree segments = AVLTree_new(sizeof(ResolvedSegment),
                                    (int8_t (*)(const void*, const void*))compare);
 
-    Breakpoint breakpoint;
-    while (BinaryHeap_pop(&breakpoints, &breakpoint)) {
-        switch (breakpoint.type) {
-            case H_SEGMENT_BEGIN:
-                avl_sweep_comes_across(&segments, &breakpoint.data);
-                break;
-            case H_SEGMENT_END:
-                avl_sweep_goes_past(&segments, &breakpoint.data);
-                break;
-            case V_SEGMENT:
-                avl_sweep_check_intersections(&intersections, &segments,
-                                              &breakpoint.data);
-                break;
-        }
+    // The horizontal segments crossing the left edge began in a previous strip.
+    const Vec* seeds = Vec_get(ps->seeds, i);
+    const size_t* seed_ids = seeds->data;
+    for (size_t k = 0; k < Vec_len(seeds); k++) {
+        ResolvedSegment seed = *ResolvedSegmentVec_at(&ps->sweep->segments, seed_ids[k]);
+        AVLTree_insert(&segments, &seed);
     }
 
-    AVLTree_clear(&segments);
-    BinaryHeap_drop(&breakpoints);
+    // The strips share the sorted breakpoints and the segment table, read only.
+    Sweep sweep = *ps->sweep;
+    sweep.next = strip->first;
+    sweep.end = strip->last;
+    avl_sweep_run(&sweep, &segments, Vec_get_mut(ps->results, i));
 
-    return intersections;
+    AVLTree_clear(&segments);
 }
 
-int8_t compare(const BreakpointData* a, const BreakpointData* b) {
-    int32_t y_a = a->ref.beg->y;
-    int32_t y_b = b->ref.beg->y;
+int8_t compare(const ResolvedSegment* a, const ResolvedSegment* b) {
+    int32_t y_a = a->y0;
+    int32_t y_b = b->y0;
 
     if (y_a < y_b) {
         return -1;
@@ -669,25 +2426,25 @@ int8_t compare(const BreakpointData* a, const BreakpointData* b) {
     }
 }
 
-void avl_sweep_comes_across(AVLTree* segments, BreakpointData* d) {
+void avl_sweep_comes_across(AVLTree* segments, ResolvedSegment* d) {
     AVLTree_insert(segments, d);
 }
 
-void avl_sweep_goes_past(AVLTree* segments, BreakpointData* d) {
+void avl_sweep_goes_past(AVLTree* segments, ResolvedSegment* d) {
     AVLTree_remove(segments, d, NULL);
 }
 
 void avl_sweep_check_intersections(IntersectionVec* intersections,
-                                   const AVLTree* segments, const BreakpointData* vd) {
+                                   const AVLTree* segments, const ResolvedSegment* vd) {
     const AVLNode* n = avl_find_sup_eq(segments->root, vd);
     // y >= y_min, but not y <= y_max.
     avl_sweep_check_iter(intersections, n, vd);
 }
 
-const AVLNode* avl_find_sup_eq(const AVLNode* n, const BreakpointData* vd) {
+const AVLNode* avl_find_sup_eq(const AVLNode* n, const ResolvedSegment* vd) {
     if (n) {
-        int32_t y_min = vd->ref.beg->y;
-        int32_t y = ((BreakpointData*)n->elem)->ref.beg->y;
+        int32_t y_min = vd->y0;
+        int32_t y = ((const ResolvedSegment*)n->elem)->y0;
 
         if (y < y_min) {
             n = avl_find_sup_eq(n->right, vd);
@@ -697,12 +2454,12 @@ const AVLNode* avl_find_sup_eq(const AVLNode* n, const BreakpointData* vd) {
 }
 
 void avl_sweep_check_iter(IntersectionVec* intersections, const AVLNode* n,
-                          const BreakpointData* vd) {
+                          const ResolvedSegment* vd) {
     if (n) {
-        int32_t y_min = vd->ref.beg->y;
-        int32_t y_max = vd->ref.end->y;
-        const BreakpointData* hd = n->elem;
-        int32_t y = hd->ref.beg->y;
+        int32_t y_min = vd->y0;
+        int32_t y_max = vd->y1;
+        const ResolvedSegment* hd = n->elem;
+        int32_t y = hd->y0;
 
         if (y < y_min) {
             avl_sweep_check_iter(intersections, n->right, vd);
@@ -712,9 +2469,9 @@ void avl_sweep_check_iter(IntersectionVec* intersections, const AVLNode* n,
             if (vd->loc.net != hd->loc.net) {
                 Intersection i = {
                     .a = vd->loc, .b = hd->loc,
-                    .point = { vd->ref.beg->x, hd->ref.beg->y }
+                    .point = { vd->x0, hd->y0 }
                 };
-                Vec_push(intersections, &i);
+                IntersectionVec_push(intersections, i);
             }
 
             avl_sweep_check_iter(intersections, n->right, vd);
@@ -723,26 +2480,331 @@ void avl_sweep_check_iter(IntersectionVec* intersections, const AVLNode* n,
     }
 }
 
-void Netlist_intersections_to_file(IntersectionVec* inters, const char* path) {
-    FILE* f = fopen(path, "w");
+IntersectionVec Netlist_intersections_grid(const Netlist* nl) {
+    IntersectionVec intersections = Vec_new(sizeof(Intersection));
+    SegmentTable table = SegmentTable_new(nl);
+    if (Vec_is_empty(&table)) {
+        Vec_drop(&table);
+        return intersections;
+    }
+
+    Grid grid = grid_new(&nl->aabb, &table);
+    GridBins h_bins = grid_bins(&grid, &table, false);
+    GridBins v_bins = grid_bins(&grid, &table, true);
+    Vec_drop(&table);
+
+    const size_t* h_offsets = h_bins.offsets.data;
+    const size_t* v_offsets = v_bins.offsets.data;
+    const ResolvedSegment* hs = h_bins.segments.data;
+    const ResolvedSegment* vs = v_bins.segments.data;
+    for (size_t row = 0; row < grid.rows; row++) {
+        for (size_t column = 0; column < grid.columns; column++) {
+            size_t c = row*grid.columns + column;
+            for (size_t i = v_offsets[c]; i < v_offsets[c + 1]; i++) {
+                const ResolvedSegment* vd = &vs[i];
+                for (size_t j = h_offsets[c]; j < h_offsets[c + 1]; j++) {
+                    const ResolvedSegment* hd = &hs[j];
+                    if (hd->x0 <= vd->x0 && vd->x0 <= hd->x1 &&
+                        vd->y0 <= hd->y0 && hd->y0 <= vd->y1 &&
+                        vd->loc.net != hd->loc.net &&
+                        // Both segments are in every cell they cross,
+                        // only the cell holding the crossing reports it.
+                        grid_column(&grid, vd->x0) == column &&
+                        grid_row(&grid, hd->y0) == row) {
+                        Intersection inter = {
+                            .a = vd->loc, .b = hd->loc,
+                            .point = { vd->x0, hd->y0 }
+                        };
+                        IntersectionVec_push(&intersections, inter);
+                    }
+                }
+            }
+        }
+    }
+
+    grid_bins_drop(&v_bins);
+    grid_bins_drop(&h_bins);
+
+    return intersections;
+}
+
+Grid grid_new(const AABB* aabb, const SegmentTable* table) {
+    // The cells are as wide as the mean horizontal segment is long
+    // and as high as the mean vertical one, so that most segments touch two cells.
+    int64_t h_length = 0, v_length = 0;
+    size_t h_count = 0, v_count = 0;
+    ResolvedSegmentConstSpan segments = ResolvedSegmentVec_span(table);
+    for (size_t i = 0; i < segments.len; i++) {
+        const ResolvedSegment* d = &segments.data[i];
+        if (d->vertical) {
+            v_length += (int64_t)d->y1 - d->y0;
+            v_count++;
+        } else {
+            h_length += (int64_t)d->x1 - d->x0;
+            h_count++;
+        }
+    }
+
+    int64_t width = (int64_t)aabb->sup.x - aabb->inf.x + 1;
+    int64_t height = (int64_t)aabb->sup.y - aabb->inf.y + 1;
+    Grid g = {
+        .origin = aabb->inf,
+        .cell_width = h_count ? int64_t_max(h_length/(int64_t)h_count, 1) : width,
+        .cell_height = v_count ? int64_t_max(v_length/(int64_t)v_count, 1) : height
+    };
+
+    // Short segments in a large box would make too many empty cells.
+    while (grid_cell_count(width, height, g.cell_width, g.cell_height) >
+           GRID_CELLS_PER_SEGMENT*segments.len) {
+        g.cell_width *= 2;
+        g.cell_height *= 2;
+    }
+
+    g.columns = (size_t)((width + g.cell_width - 1)/g.cell_width);
+    g.rows = (size_t)((height + g.cell_height - 1)/g.cell_height);
+    return g;
+}
+
+size_t grid_cell_count(int64_t width, int64_t height, int64_t cell_width, int64_t cell_height) {
+    // A wide box of small cells overflows, it only has to be enlarged.
+    size_t count;
+    if (__builtin_mul_overflow((size_t)((width + cell_width - 1)/cell_width),
+                               (size_t)((height + cell_height - 1)/cell_height), &count)) {
+        return SIZE_MAX;
+    }
+    return count;
+}
+
+size_t grid_column(const Grid* g, int32_t x) {
+    // Clamped, in case a point lies outside of the netlist aabb.
+    int64_t column = ((int64_t)x - g->origin.x)/g->cell_width;
+    return (size_t)int64_t_min(int64_t_max(column, 0), (int64_t)g->columns - 1);
+}
+
+size_t grid_row(const Grid* g, int32_t y) {
+    int64_t row = ((int64_t)y - g->origin.y)/g->cell_height;
+    return (size_t)int64_t_min(int64_t_max(row, 0), (int64_t)g->rows - 1);
+}
+
+GridBins grid_bins(const Grid* g, const SegmentTable* table, bool vertical) {
+    size_t cell_count;
+    if (__builtin_mul_overflow(g->columns, g->rows, &cell_count) || cell_count == SIZE_MAX) {
+        perror("too many grid cells");
+        exit(1);
+    }
+    Vec offsets = Vec_with_capacity(cell_count + 1, sizeof(size_t));
+    for (size_t c = 0; c <= cell_count; c++) {
+        Vec_push(&offsets, &(size_t) { 0 });
+    }
+    size_t* offset = offsets.data;
+
+    // Counted first, the c-th cell then starts at `offset[c]`.
+    ResolvedSegmentConstSpan segments = ResolvedSegmentVec_span(table);
+    for (size_t i = 0; i < segments.len; i++) {
+        const ResolvedSegment* d = &segments.data[i];
+        if (d->vertical != vertical) continue;
+        if (vertical) {
+            size_t column = grid_column(g, d->x0);
+            for (size_t r = grid_row(g, d->y0); r <= grid_row(g, d->y1); r++) {
+                offset[r*g->columns + column + 1]++;
+            }
+        } else {
+            size_t row = grid_row(g, d->y0);
+            for (size_t c = grid_column(g, d->x0); c <= grid_column(g, d->x1); c++) {
+                offset[row*g->columns + c + 1]++;
+            }
+        }
+    }
+    for (size_t c = 0; c < cell_count; c++) {
+        offset[c + 1] += offset[c];
+    }
+
+    Vec binned = Vec_with_capacity(offset[cell_count], sizeof(ResolvedSegment));
+    binned.len = offset[cell_count];
+    ResolvedSegment* bin = binned.data;
+    for (size_t i = 0; i < segments.len; i++) {
+        const ResolvedSegment* d = &segments.data[i];
+        if (d->vertical != vertical) continue;
+        if (vertical) {
+            size_t column = grid_column(g, d->x0);
+            for (size_t r = grid_row(g, d->y0); r <= grid_row(g, d->y1); r++) {
+                bin[offset[r*g->columns + column]++] = *d;
+            }
+        } else {
+            size_t row = grid_row(g, d->y0);
+            for (size_t c = grid_column(g, d->x0); c <= grid_column(g, d->x1); c++) {
+                bin[offset[row*g->columns + c]++] = *d;
+            }
+        }
+    }
+    // Filling moved every offset to the start of the next cell.
+    for (size_t c = cell_count; c > 0; c--) {
+        offset[c] = offset[c - 1];
+    }
+    offset[0] = 0;
+
+    return (GridBins) { .offsets = offsets, .segments = binned };
+}
+
+void grid_bins_drop(GridBins* bins) {
+    Vec_drop(&bins->offsets);
+    Vec_drop(&bins->segments);
+}
+
+void Netlist_intersections_to_file(IntersectionVec* inters, const char* path,
+                                   IntersectionFormat format) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        perror("cannot open intersection output file");
+        exit(1);
+    }
+
+    switch (format) {
+        case BINARY_INTERSECTIONS:
+            intersections_to_binary_file(inters, f);
+            break;
+        case TEXT_INTERSECTIONS:
+            intersections_to_text_file(inters, f);
+            break;
+    }
+
+    fclose(f);
+}
+
+void intersections_to_text_file(IntersectionVec* inters, FILE* f) {
+    Writer w = Writer_new(f);
+    Writer_put_parallel(&w, Vec_len(inters), 0,
+                        intersection_to_text, inters);
+    Writer_drop(&w);
+}
+
+void intersection_to_text(Writer* w, const void* inters, size_t i) {
+    const Intersection* inter = Vec_unsafe_get(inters, i);
+
+    Writer_put_size(w, inter->a.net);
+    Writer_put_char(w, ' ');
+    Writer_put_size(w, inter->a.seg);
+    Writer_put_char(w, ' ');
+    Writer_put_size(w, inter->b.net);
+    Writer_put_char(w, ' ');
+    Writer_put_size(w, inter->b.seg);
+    Writer_put_char(w, '\n');
+}
+
+void intersections_to_binary_file(IntersectionVec* inters, FILE* f) {
+    // The records are written as is, so the host has to be little-endian.
+    uint16_t one = 1;
+    assert(*(const uint8_t*)&one == 1);
 
     size_t inter_count = Vec_len(inters);
+    IntersectionHeader h = {
+        .version = INTERSECTION_FILE_VERSION,
+        .reserved = 0,
+        .count = inter_count
+    };
+    memcpy(h.magic, intersection_magic, sizeof(h.magic));
+
+    Vec records = Vec_with_capacity(inter_count, sizeof(IntersectionRecord));
     for (size_t i = 0; i < inter_count; i++) {
         const Intersection* inter = Vec_get(inters, i);
+        IntersectionRecord r = {
+            .a_net = checked_u32(inter->a.net), .a_seg = checked_u32(inter->a.seg),
+            .b_net = checked_u32(inter->b.net), .b_seg = checked_u32(inter->b.seg)
+        };
+        Vec_push(&records, &r);
+    }
+
+    size_t records_size = inter_count*sizeof(IntersectionRecord);
+    if (fwrite(&h, sizeof(h), 1, f) != 1 ||
+        (records_size > 0 && fwrite(records.data, records_size, 1, f) != 1)) {
+        perror("cannot write intersection file");
+        exit(1);
+    }
+
+    Vec_drop(&records);
+}
 
-        fprintf(f, "%zu %zu %zu %zu\n",
-                inter->a.net, inter->a.seg,
-                inter->b.net, inter->b.seg);
+uint32_t checked_u32(size_t n) {
+    if (n > UINT32_MAX) {
+        perror("index too large for the binary intersection format");
+        exit(1);
     }
+    return (uint32_t)n;
+}
 
-    fclose(f);
+IntersectionVec Netlist_intersections_from_file(const Netlist* nl, const char* path) {
+    IntersectionVec intersections = Vec_new(sizeof(Intersection));
+    IntersectionLoad load = { .nl = nl, .intersections = &intersections };
+    intersections_for_each(path,
+                           (void (*)(void*, SegmentLoc, SegmentLoc))intersection_from_locs, &load);
+    return intersections;
+}
+
+void intersection_from_locs(IntersectionLoad* load, SegmentLoc a, SegmentLoc b) {
+    a = Netlist_loc_from_file(load->nl, a);
+    b = Netlist_loc_from_file(load->nl, b);
+    const Net* a_net = Vec_get(&load->nl->nets, a.net);
+    const Net* b_net = Vec_get(&load->nl->nets, b.net);
+    ResolvedSegment a_seg = resolve_net_segment(a_net, a);
+    ResolvedSegment b_seg = resolve_net_segment(b_net, b);
+
+    Intersection intersection = { .a = a, .b = b };
+    if (!segment_intersects(&a_seg, &b_seg, &intersection.point)) {
+        SYNTAX_ERROR("intersection file does not match the netlist");
+    }
+    Vec_push(load->intersections, &intersection);
+}
+
+void intersections_for_each(const char* path, void (*f)(void*, SegmentLoc, SegmentLoc),
+                            void* ctx) {
+    MappedFile int_f = MappedFile_open(path);
+
+    if (int_f.len >= sizeof(IntersectionHeader) &&
+        memcmp(int_f.data, intersection_magic, sizeof(intersection_magic)) == 0) {
+        IntersectionHeader h;
+        memcpy(&h, int_f.data, sizeof(h));
+        if (h.version != INTERSECTION_FILE_VERSION ||
+            int_f.len != sizeof(h) + h.count*sizeof(IntersectionRecord)) {
+            SYNTAX_ERROR("unexpected binary intersection header");
+        }
+
+        // The mapping is page aligned, so are the records.
+        const IntersectionRecord* records =
+            (const IntersectionRecord*)(int_f.data + sizeof(h));
+        for (size_t i = 0; i < h.count; i++) {
+            const IntersectionRecord* r = &records[i];
+            f(ctx, (SegmentLoc) { .net = r->a_net, .seg = r->a_seg },
+                   (SegmentLoc) { .net = r->b_net, .seg = r->b_seg });
+        }
+    } else {
+        Scanner s = Scanner_new(int_f.data, int_f.len);
+        while (!Scanner_is_empty(&s)) {
+            int64_t v[4];
+            size_t count = Tokenizer_line(&s, v, 4);
+            if (count == 0 && Scanner_is_empty(&s)) break; // trailing blank line
+            if (count == TOKENIZER_MALFORMED || count < 4 || v[0] < 0 || v[1] < 0 || v[2] < 0 || v[3] < 0) {
+                SYNTAX_ERROR("expected `a_net a_seg b_net b_seg` intersection description");
+            }
+            for (size_t i = 0; i < 4; i++) {
+                check_index_fits((uint64_t)v[i]);
+            }
+            f(ctx, (SegmentLoc) { .net = (index_t)v[0], .seg = (index_t)v[1] },
+                   (SegmentLoc) { .net = (index_t)v[2], .seg = (index_t)v[3] });
+        }
+    }
+
+    MappedFile_drop(&int_f);
 }
 
 Graph Graph_new(const Netlist* nl, const char* int_path) {
+    return Graph_new_in(nl, int_path, NULL);
+}
+
+Graph Graph_new_in(const Netlist* nl, const char* int_path, Allocator* a) {
     size_t nodes_count = 0;
 
     size_t net_count = Vec_len(&nl->nets);
-    Vec net_offsets = Vec_with_capacity(net_count, sizeof(size_t));
+    Vec net_offsets = Vec_with_capacity_in(net_count, sizeof(size_t), a);
     for (size_t n = 0; n < net_count; n++) {
         const Net* net = Vec_get(&nl->nets, n);
         Vec_push(&net_offsets, &nodes_count);
@@ -750,91 +2812,356 @@ Graph Graph_new(const Netlist* nl, const char* int_path) {
         nodes_count += Vec_len(&net->points);
         nodes_count += Vec_len(&net->segments);
     }
+    check_index_fits(nodes_count);
 
-    GraphNodeVec nodes = Vec_with_capacity(nodes_count, sizeof(GraphNode));
+    GraphNodeVec nodes = Vec_with_capacity_in(nodes_count, sizeof(GraphNode), a);
 
-    // Setting up nodes and continuity edges.
-    for (size_t n = 0; n < net_count; n++) {
+    // Setting up nodes, their continuity follows from the segments.
+    NetConstSpan nets = NetVec_span(&nl->nets);
+    for (size_t n = 0; n < nets.len; n++) {
         size_t net_offset = Vec_len(&nodes);
-        const Net* net = Vec_get(&nl->nets, n);
+        const Net* net = &nets.data[n];
 
         size_t point_count = Vec_len(&net->points);
         for (size_t p = 0; p < point_count; p++) {
             GraphNode node = {
                 .type = POINT_NODE,
-                .point = Vec_get(&net->points, p),
-                .continuity = Vec_new(sizeof(GraphEdge)),
-                .conflict = Vec_new(sizeof(GraphEdge))
+                .net_offset = net_offset,
+                .point = PointVec_at(&net->points, p)
             };
-            Vec_push(&nodes, &node);
+            GraphNodeVec_push(&nodes, node);
         }
 
         size_t segment_count = Vec_len(&net->segments);
         for (size_t s = 0; s < segment_count; s++) {
             GraphNode node = {
                 .type = SEGMENT_NODE,
-                .segment = Vec_get(&net->segments, s),
-                .continuity = Vec_new(sizeof(GraphEdge)),
-                .conflict = Vec_new(sizeof(GraphEdge))
+                .net_offset = net_offset,
+                .segment = SegmentVec_at(&net->segments, s)
             };
-            size_t node_index = Vec_len(&nodes);
-            size_t beg_index = (net_offset + node.segment->beg);
-            size_t end_index = (net_offset + node.segment->end);
-            GraphEdge from_beg = { .u = beg_index,  .v = node_index };
-            GraphEdge to_beg   = { .u = node_index, .v = beg_index  };
-            GraphEdge from_end = { .u = end_index,  .v = node_index };
-            GraphEdge to_end   = { .u = node_index, .v = end_index  };
-            Vec_push(&node.continuity, &to_beg);
-            Vec_push(&node.continuity, &to_end);
-            GraphNode* beg = Vec_get_mut(&nodes, beg_index);
-            GraphNode* end = Vec_get_mut(&nodes, end_index);
-            Vec_push(&beg->continuity, &from_beg);
-            Vec_push(&end->continuity, &from_end);
-            Vec_push(&nodes, &node);
+            GraphNodeVec_push(&nodes, node);
         }
     }
+    GraphAdjacency continuity = point_continuity(&nodes, a);
 
-    FILE* int_f = fopen(int_path, "r");
-
-    char line[255];
     // Setting up conflict edges.
-    while (fgets(line, 255, int_f)) {
-        SegmentLoc a_loc, b_loc;
-        if (sscanf(line, "%zu %zu %zu %zu",
-                   &a_loc.net, &a_loc.seg, &b_loc.net, &b_loc.seg) != 4) {
-            SYNTAX_ERROR("expected `a_net a_seg b_net b_seg` intersection description");
+    GraphEdgeVec edges = Vec_new_in(sizeof(GraphEdge), a);
+    GraphConflicts gc = { .edges = &edges, .net_offsets = &net_offsets, .nl = nl };
+    intersections_for_each(int_path,
+                           (void (*)(void*, SegmentLoc, SegmentLoc))graph_add_conflict, &gc);
+    GraphAdjacency conflict = adjacency_from_edges(nodes_count, &edges, a);
+    Vec_drop(&edges);
+
+    return (Graph) {
+        .nodes = nodes,
+        .continuity = continuity,
+        .conflict = conflict,
+        .net_offsets = net_offsets
+    };
+}
+
+void graph_add_conflict(GraphConflicts* gc, SegmentLoc a_loc, SegmentLoc b_loc) {
+    a_loc = Netlist_loc_from_file(gc->nl, a_loc);
+    b_loc = Netlist_loc_from_file(gc->nl, b_loc);
+    size_t a_net_offset = *(const size_t*)Vec_get(gc->net_offsets, a_loc.net);
+    size_t b_net_offset = *(const size_t*)Vec_get(gc->net_offsets, b_loc.net);
+    const Net* a_net = Vec_get(&gc->nl->nets, a_loc.net);
+    const Net* b_net = Vec_get(&gc->nl->nets, b_loc.net);
+    // The edges are written unchecked into the adjacency, the nodes must exist.
+    if (a_loc.seg >= Vec_len(&a_net->segments) || b_loc.seg >= Vec_len(&b_net->segments)) {
+        SYNTAX_ERROR("intersection file does not match the netlist");
+    }
+    size_t a_index = a_net_offset + Vec_len(&a_net->points) + a_loc.seg;
+    size_t b_index = b_net_offset + Vec_len(&b_net->points) + b_loc.seg;
+    graph_push_edge(gc->edges, a_index, b_index);
+    graph_push_edge(gc->edges, b_index, a_index);
+}
+
+void graph_push_edge(GraphEdgeVec* edges, size_t u, size_t v) {
+    GraphEdge edge = { .u = u, .v = v };
+    GraphEdgeVec_push(edges, edge);
+}
+
+GraphAdjacency adjacency_from_edges(size_t node_count, const GraphEdgeVec* edges,
+                                    Allocator* a) {
+    size_t edge_count = Vec_len(edges);
+
+    // Counting the degrees, then summing them up into offsets.
+    Vec offsets = Vec_with_capacity_in(node_count + 1, sizeof(size_t), a);
+    size_t zero = 0;
+    for (size_t n = 0; n <= node_count; n++) {
+        Vec_push(&offsets, &zero);
+    }
+    size_t* offset = offsets.data;
+    for (size_t e = 0; e < edge_count; e++) {
+        offset[GraphEdgeVec_at(edges, e)->u + 1]++;
+    }
+    for (size_t n = 0; n < node_count; n++) {
+        offset[n + 1] += offset[n];
+    }
+
+    // Filling the targets in the edge order, `cursor[n]` is the next free slot of `n`.
+    Vec cursors = Vec_with_capacity_in(node_count, sizeof(size_t), a);
+    memcpy(cursors.data, offset, node_count*sizeof(size_t));
+    cursors.len = node_count;
+    size_t* cursor = cursors.data;
+    Vec targets = Vec_with_capacity_in(edge_count, sizeof(index_t), a);
+    index_t* target = targets.data;
+    for (size_t e = 0; e < edge_count; e++) {
+        const GraphEdge* edge = GraphEdgeVec_at(edges, e);
+        target[cursor[edge->u]++] = edge->v;
+    }
+    targets.len = edge_count;
+    Vec_drop(&cursors);
+
+    return (GraphAdjacency) {
+        .offsets = offsets,
+        .targets = targets
+    };
+}
+
+GraphAdjacency point_continuity(const GraphNodeVec* nodes, Allocator* a) {
+    size_t node_count = Vec_len(nodes);
+
+    // Same steps as `adjacency_from_edges`, the edges go from the segment ends
+    // to the segment and are listed in the segment order.
+    Vec offsets = Vec_with_capacity_in(node_count + 1, sizeof(size_t), a);
+    size_t zero = 0;
+    for (size_t n = 0; n <= node_count; n++) {
+        Vec_push(&offsets, &zero);
+    }
+    size_t* offset = offsets.data;
+    size_t edge_count = 0;
+    for (size_t n = 0; n < node_count; n++) {
+        const GraphNode* node = GraphNodeVec_at(nodes, n);
+        if (node->type == SEGMENT_NODE) {
+            offset[segment_end_node(nodes, node, node->segment->beg) + 1]++;
+            offset[segment_end_node(nodes, node, node->segment->end) + 1]++;
+            edge_count += 2;
+        }
+    }
+    for (size_t n = 0; n < node_count; n++) {
+        offset[n + 1] += offset[n];
+    }
+
+    Vec cursors = Vec_with_capacity_in(node_count, sizeof(size_t), a);
+    memcpy(cursors.data, offset, node_count*sizeof(size_t));
+    cursors.len = node_count;
+    size_t* cursor = cursors.data;
+    Vec targets = Vec_with_capacity_in(edge_count, sizeof(index_t), a);
+    index_t* target = targets.data;
+    for (size_t n = 0; n < node_count; n++) {
+        const GraphNode* node = GraphNodeVec_at(nodes, n);
+        if (node->type == SEGMENT_NODE) {
+            target[cursor[node->net_offset + node->segment->beg]++] = n;
+            target[cursor[node->net_offset + node->segment->end]++] = n;
+        }
+    }
+    targets.len = edge_count;
+    Vec_drop(&cursors);
+
+    return (GraphAdjacency) {
+        .offsets = offsets,
+        .targets = targets
+    };
+}
+
+size_t segment_end_node(const GraphNodeVec* nodes, const GraphNode* node, index_t end) {
+    // The adjacency is written unchecked: the end has to be a point of the segment net.
+    size_t n = node->net_offset + end;
+    if (n >= Vec_len(nodes) || GraphNodeVec_at(nodes, n)->type != POINT_NODE ||
+        GraphNodeVec_at(nodes, n)->net_offset != node->net_offset) {
+        perror("segment end out of its net points");
+        exit(1);
+    }
+    return n;
+}
+
+void Graph_continuity(const Graph* g, size_t n, GraphContinuity* c) {
+    const GraphNode* node = GraphNodeVec_at(&g->nodes, n);
+    if (node->type == SEGMENT_NODE) {
+        c->ends[0] = node->net_offset + node->segment->beg;
+        c->ends[1] = node->net_offset + node->segment->end;
+        if (!Vec_is_empty(&g->rank)) {
+            // The ends are found in the layout, they have to be relabelled too.
+            const index_t* rank = g->rank.data;
+            c->ends[0] = rank[c->ends[0]];
+            c->ends[1] = rank[c->ends[1]];
         }
+        c->nodes = c->ends;
+        c->count = 2;
+    } else {
+        c->nodes = GraphAdjacency_neighbours(&g->continuity, n);
+        c->count = GraphAdjacency_degree(&g->continuity, n);
+    }
+}
+
+size_t GraphAdjacency_degree(const GraphAdjacency* adj, size_t n) {
+    const size_t* offset = adj->offsets.data;
+    return offset[n + 1] - offset[n];
+}
+
+const index_t* GraphAdjacency_neighbours(const GraphAdjacency* adj, size_t n) {
+    const size_t* offset = adj->offsets.data;
+    return (const index_t*)adj->targets.data + offset[n];
+}
+
+Graph Graph_relabelled(const Graph* g) {
+    assert(Vec_is_empty(&g->order));
+    size_t node_count = Vec_len(&g->nodes);
+
+    Vec order = cuthill_mckee_order(g);
+    Vec rank = Vec_with_capacity(node_count, sizeof(index_t));
+    const index_t* old_index = order.data;
+    index_t* new_index = rank.data;
+    for (size_t i = 0; i < node_count; i++) {
+        new_index[old_index[i]] = (index_t)i;
+    }
+    rank.len = node_count;
 
-        size_t a_net_offset = *(const size_t*)Vec_get(&net_offsets, a_loc.net);
-        size_t b_net_offset = *(const size_t*)Vec_get(&net_offsets, b_loc.net);
-        const Net* a_net = Vec_get(&nl->nets, a_loc.net);
-        const Net* b_net = Vec_get(&nl->nets, b_loc.net);
-        size_t a_index = a_net_offset + Vec_len(&a_net->points) + a_loc.seg;
-        size_t b_index = b_net_offset + Vec_len(&b_net->points) + b_loc.seg;
-        GraphEdge ab_conflict = { .u = a_index, .v = b_index };
-        GraphEdge ba_conflict = { .u = b_index, .v = a_index };
-        GraphNode* a = Vec_get_mut(&nodes, a_index);
-        GraphNode* b = Vec_get_mut(&nodes, b_index);
-        Vec_push(&a->conflict, &ab_conflict);
-        Vec_push(&b->conflict, &ba_conflict);
+    GraphNodeVec nodes = Vec_with_capacity(node_count, sizeof(GraphNode));
+    for (size_t i = 0; i < node_count; i++) {
+        GraphNodeVec_push(&nodes, *GraphNodeVec_at(&g->nodes, old_index[i]));
     }
 
-    fclose(int_f);
+    Vec net_offsets = Vec_with_capacity(Vec_len(&g->net_offsets), sizeof(size_t));
+    memcpy(net_offsets.data, g->net_offsets.data, Vec_len(&g->net_offsets)*sizeof(size_t));
+    net_offsets.len = Vec_len(&g->net_offsets);
 
     return (Graph) {
         .nodes = nodes,
-        .net_offsets = net_offsets
+        .continuity = relabel_adjacency(&g->continuity, node_count, old_index, new_index),
+        .conflict = relabel_adjacency(&g->conflict, node_count, old_index, new_index),
+        .net_offsets = net_offsets,
+        .order = order,
+        .rank = rank
+    };
+}
+
+Vec cuthill_mckee_order(const Graph* g) {
+    size_t node_count = Vec_len(&g->nodes);
+
+    // Sorting the nodes by degree with a counting sort,
+    // the components are entered from their first node in this order.
+    Vec degrees = Vec_with_capacity(node_count, sizeof(size_t));
+    size_t* degree = degrees.data;
+    size_t max_degree = 0;
+    for (size_t n = 0; n < node_count; n++) {
+        degree[n] = node_degree(g, n);
+        max_degree = size_t_max(max_degree, degree[n]);
+    }
+    degrees.len = node_count;
+
+    Vec counts = Vec_with_capacity(max_degree + 2, sizeof(size_t));
+    size_t* count = counts.data;
+    memset(count, 0, (max_degree + 2)*sizeof(size_t));
+    for (size_t n = 0; n < node_count; n++) {
+        count[degree[n] + 1]++;
+    }
+    for (size_t d = 0; d <= max_degree; d++) {
+        count[d + 1] += count[d];
+    }
+    Vec by_degrees = Vec_with_capacity(node_count, sizeof(index_t));
+    index_t* by_degree = by_degrees.data;
+    for (size_t n = 0; n < node_count; n++) {
+        by_degree[count[degree[n]]++] = (index_t)n;
+    }
+    Vec_drop(&counts);
+
+    // Breadth first, the order being its own queue.
+    Vec orders = Vec_with_capacity(node_count, sizeof(index_t));
+    index_t* order = orders.data;
+    size_t len = 0, head = 0;
+    BitSet visited = BitSet_with_capacity(node_count);
+    for (size_t r = 0; r < node_count; r++) {
+        if (!BitSet_insert(&visited, by_degree[r])) continue;
+        order[len++] = by_degree[r];
+
+        while (head < len) {
+            size_t u = order[head++];
+            size_t first = len;
+
+            size_t conflict_count = GraphAdjacency_degree(&g->conflict, u);
+            const index_t* conflict = GraphAdjacency_neighbours(&g->conflict, u);
+            for (size_t c = 0; c < conflict_count; c++) {
+                if (BitSet_insert(&visited, conflict[c])) order[len++] = conflict[c];
+            }
+            GraphContinuity continuity;
+            Graph_continuity(g, u, &continuity);
+            for (size_t c = 0; c < continuity.count; c++) {
+                if (BitSet_insert(&visited, continuity.nodes[c])) order[len++] = continuity.nodes[c];
+            }
+
+            // Few nodes are queued at once, an insertion sort by degree does it.
+            for (size_t i = first + 1; i < len; i++) {
+                index_t v = order[i];
+                size_t j = i;
+                while (j > first && degree[order[j - 1]] > degree[v]) {
+                    order[j] = order[j - 1];
+                    j--;
+                }
+                order[j] = v;
+            }
+        }
+    }
+    BitSet_drop(&visited);
+    Vec_drop(&by_degrees);
+    Vec_drop(&degrees);
+
+    // Reversing gives a smaller profile than the plain Cuthill-McKee order.
+    for (size_t i = 0; i < len/2; i++) {
+        index_t t = order[i];
+        order[i] = order[len - 1 - i];
+        order[len - 1 - i] = t;
+    }
+    orders.len = len;
+
+    return orders;
+}
+
+size_t node_degree(const Graph* g, size_t n) {
+    GraphContinuity continuity;
+    Graph_continuity(g, n, &continuity);
+    return GraphAdjacency_degree(&g->conflict, n) + continuity.count;
+}
+
+GraphAdjacency relabel_adjacency(const GraphAdjacency* adj, size_t node_count,
+                                 const index_t* order, const index_t* rank) {
+    Vec offsets = Vec_with_capacity(node_count + 1, sizeof(size_t));
+    Vec targets = Vec_with_capacity(Vec_len(&adj->targets), sizeof(index_t));
+    size_t* offset = offsets.data;
+    index_t* target = targets.data;
+
+    offset[0] = 0;
+    for (size_t i = 0; i < node_count; i++) {
+        size_t degree = GraphAdjacency_degree(adj, order[i]);
+        const index_t* neighbours = GraphAdjacency_neighbours(adj, order[i]);
+        for (size_t c = 0; c < degree; c++) {
+            target[offset[i] + c] = rank[neighbours[c]];
+        }
+        offset[i + 1] = offset[i] + degree;
+    }
+    offsets.len = node_count + 1;
+    targets.len = offset[node_count];
+
+    return (GraphAdjacency) {
+        .offsets = offsets,
+        .targets = targets
     };
 }
 
 void Graph_drop(Graph* g) {
-    Vec_drop_with(&g->nodes, (void (*)(void*))graph_node_drop);
+    Vec_drop(&g->nodes);
+    adjacency_drop(&g->continuity);
+    adjacency_drop(&g->conflict);
     Vec_drop(&g->net_offsets);
+    Vec_drop(&g->order);
+    Vec_drop(&g->rank);
 }
 
-void graph_node_drop(GraphNode* n) {
-    Vec_drop(&n->continuity);
-    Vec_drop(&n->conflict);
+void adjacency_drop(GraphAdjacency* adj) {
+    Vec_drop(&adj->offsets);
+    Vec_drop(&adj->targets);
 }
 
 BitSet Graph_hv_solve(const Graph* g, const Netlist* nl) {
@@ -850,7 +3177,7 @@ BitSet Graph_hv_solve(const Graph* g, const Netlist* nl) {
         offset += point_count;
 
         for (size_t i = offset; i < (offset + segment_count); i++) {
-            const GraphNode* node = Vec_get(&g->nodes, i);
+            const GraphNode* node = GraphNodeVec_at(&g->nodes, i);
             const Point* beg = Vec_get(&net->points, node->segment->beg);
             const Point* end = Vec_get(&net->points, node->segment->end);
             if (beg->x == end->x) { // |, we change side
@@ -868,15 +3195,13 @@ BitSet Graph_hv_solve(const Graph* g, const Netlist* nl) {
         size_t segment_count = Vec_len(&net->segments);
 
         for (size_t i = offset; i < (offset + point_count); i++) {
-            const GraphNode* node = Vec_get(&g->nodes, i);
-            size_t continuity_count = Vec_len(&node->continuity);
+            size_t continuity_count = GraphAdjacency_degree(&g->continuity, i);
+            const index_t* continuity = GraphAdjacency_neighbours(&g->continuity, i);
             if (continuity_count > 0) {
-                const GraphEdge* first_edge = Vec_get(&node->continuity, 0);
-                bool first_face = BitSet_contains(&solution, first_edge->v);
+                bool first_face = BitSet_contains(&solution, continuity[0]);
 
                 for (size_t c = 1; c < continuity_count; c++) {
-                    const GraphEdge* edge = Vec_get(&node->continuity, c);
-                    bool face = BitSet_contains(&solution, edge->v);
+                    bool face = BitSet_contains(&solution, continuity[c]);
                     if (face != first_face) { // a via is needed
                         BitSet_insert(&solution, i);
                         break;
@@ -915,9 +3240,8 @@ BitSet Graph_odd_cycle_solve(const Graph* g) {
 
 Vec new_marks(size_t node_count) {
     Vec marks = Vec_with_capacity(node_count, sizeof(NodeMark));
-    NodeMark u = UNVISITED_NODE;
     for (size_t n = 0; n < node_count; n++) {
-        Vec_push(&marks, &u);
+        NodeMarkVec_push(&marks, UNVISITED_NODE);
     }
     return marks;
 }
@@ -926,7 +3250,7 @@ void add_via_with_cycle(BitSet* solution, const Vec* cycle, const Graph* g) {
     size_t len = Vec_len(cycle);
     for (size_t i = 0; i < len; i++) {
         size_t c = *(const size_t*)Vec_get(cycle, i);
-        const GraphNode* node = Vec_get(&g->nodes, c);
+        const GraphNode* node = GraphNodeVec_at(&g->nodes, c);
         if (node->type == POINT_NODE) {
             assert(BitSet_insert(solution, c));
             return;
@@ -936,14 +3260,13 @@ void add_via_with_cycle(BitSet* solution, const Vec* cycle, const Graph* g) {
 }
 
 void reset_marks(Vec* marks, const BitSet* solution, const Graph* g) {
-    size_t len = Vec_len(marks);
-    for (size_t n = 0; n < len; n++) {
-        const GraphNode* node = Vec_get(&g->nodes, n);
-        NodeMark* m = Vec_get_mut(marks, n);
-        if (node->type == POINT_NODE && BitSet_contains(solution, n)) {
-            *m = CLOSED_NODE;
+    GraphNodeConstSpan nodes = GraphNodeVec_span(&g->nodes);
+    NodeMarkSpan m = NodeMarkVec_span_mut(marks);
+    for (size_t n = 0; n < m.len; n++) {
+        if (nodes.data[n].type == POINT_NODE && BitSet_contains(solution, n)) {
+            m.data[n] = CLOSED_NODE;
         } else {
-            *m = UNVISITED_NODE;
+            m.data[n] = UNVISITED_NODE;
         }
     }
 }
@@ -953,7 +3276,7 @@ Vec Graph_find_odd_cycle(const Graph* g, Vec* marks) {
     Vec rev_path = Vec_new(sizeof(size_t));
 
     for (size_t n = 0; n < node_count; n++) {
-        NodeMark m = *(const NodeMark*)Vec_get(marks, n);
+        NodeMark m = *NodeMarkVec_at(marks, n);
         if (m == UNVISITED_NODE &&
             Graph_find_odd_cycle_from(g, n, &rev_path, marks, A_OPENED_NODE)) {
 
@@ -982,20 +3305,19 @@ bool Graph_find_odd_cycle_from(const Graph* g, size_t root, Vec* path,
                                Vec* marks, NodeMark mark) {
     bool found = false;
 
-    NodeMark* m = Vec_get_mut(marks, root);
-    *m = mark;
+    *NodeMarkVec_at_mut(marks, root) = mark;
 
-    const GraphNode* n = Vec_get(&g->nodes, root);
-    size_t conflict_count = Vec_len(&n->conflict);
-    size_t continuity_count = Vec_len(&n->continuity);
-    for (size_t c = 0; c < (conflict_count + continuity_count); c++) {
-        const GraphEdge* e;
-        if (c < conflict_count) // TODO: they are better ways to do that.
-            e = Vec_get(&n->conflict, c);
-        else e = Vec_get(&n->continuity, c - conflict_count);
-        size_t v = e->v;
-
-        NodeMark v_mark = *(const NodeMark*)Vec_get(marks, v);
+    size_t conflict_count = GraphAdjacency_degree(&g->conflict, root);
+    const index_t* conflict = GraphAdjacency_neighbours(&g->conflict, root);
+    GraphContinuity continuity;
+    Graph_continuity(g, root, &continuity);
+    for (size_t c = 0; c < (conflict_count + continuity.count); c++) {
+        size_t v;
+        if (c < conflict_count)
+            v = conflict[c];
+        else v = continuity.nodes[c - conflict_count];
+
+        NodeMark v_mark = *NodeMarkVec_at(marks, v);
         if (v_mark == UNVISITED_NODE) {
             if (mark == A_OPENED_NODE)
                 v_mark = B_OPENED_NODE;
@@ -1042,10 +3364,10 @@ void Graph_solve_faces_from(const Graph* g, size_t root, BitSet* solution,
         if (BitSet_contains(solution, root)) return;
     }
 
-    size_t conflict_count = Vec_len(&n->conflict);
+    size_t conflict_count = GraphAdjacency_degree(&g->conflict, root);
+    const index_t* conflict = GraphAdjacency_neighbours(&g->conflict, root);
     for (size_t c = 0; c < conflict_count; c++) {
-        const GraphEdge* e = Vec_get(&n->conflict, c);
-        size_t v = e->v;
+        size_t v = conflict[c];
 
         // The only way to avoid the conflict is to change side.
         if (!BitSet_contains(visited, v)) {
@@ -1055,10 +3377,10 @@ void Graph_solve_faces_from(const Graph* g, size_t root, BitSet* solution,
         }
     }
 
-    size_t continuity_count = Vec_len(&n->continuity);
-    for (size_t c = 0; c < continuity_count; c++) {
-        const GraphEdge* e = Vec_get(&n->continuity, c);
-        size_t v = e->v;
+    GraphContinuity continuity;
+    Graph_continuity(g, root, &continuity);
+    for (size_t c = 0; c < continuity.count; c++) {
+        size_t v = continuity.nodes[c];
 
         // We have to continue on the same side if there is no via.
         if (!BitSet_contains(visited, v)) {
@@ -1067,16 +3389,77 @@ void Graph_solve_faces_from(const Graph* g, size_t root, BitSet* solution,
     }
 }
 
+BitSet Solution_to_layout(const BitSet* solution, const Graph* g) {
+    size_t node_count = Vec_len(&g->nodes);
+    BitSet layout = BitSet_with_capacity(node_count);
+
+    const index_t* order = g->order.data;
+    bool relabelled = !Vec_is_empty(&g->order);
+    for (size_t n = 0; n < node_count; n++) {
+        if (BitSet_contains(solution, n)) {
+            BitSet_insert(&layout, relabelled ? order[n] : n);
+        }
+    }
+
+    return layout;
+}
+
 size_t Solution_via_count(const BitSet* solution, const Graph* g) {
     size_t count = 0;
 
     size_t len = Vec_len(&g->nodes);
     for (size_t n = 0; n < len; n++) {
         if (BitSet_contains(solution, n)) {
-            const GraphNode* node = Vec_get(&g->nodes, n);
-            if (node->type == POINT_NODE) count++;
+            if (GraphNodeVec_at(&g->nodes, n)->type == POINT_NODE) count++;
         }
     }
 
     return count;
 }
+
+void Solution_to_file(const BitSet* solution, const Graph* g, const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        perror("cannot open solution output file");
+        exit(1);
+    }
+    Writer w = Writer_new(f);
+
+    size_t len = Vec_len(&g->nodes);
+    Writer_put_size(&w, len);
+    Writer_put_char(&w, '\n');
+    for (size_t n = 0; n < len; n++) {
+        if (BitSet_contains(solution, n)) {
+            Writer_put_size(&w, n);
+            Writer_put_char(&w, '\n');
+        }
+    }
+
+    Writer_drop(&w);
+    fclose(f);
+}
+
+BitSet Solution_from_file(const Graph* g, const char* path) {
+    MappedFile mf = MappedFile_open(path);
+    Scanner s = Scanner_new(mf.data, mf.len);
+
+    size_t len = Vec_len(&g->nodes);
+    size_t node_count;
+    if (!Scanner_size(&s, &node_count) || node_count != len) {
+        SYNTAX_ERROR("expected the graph node count on first line");
+    }
+    Scanner_skip_line(&s);
+
+    BitSet solution = BitSet_with_capacity(len);
+    while (!Scanner_is_empty(&s)) {
+        size_t n;
+        if (!Scanner_size(&s, &n) || n >= len) {
+            SYNTAX_ERROR("expected a node index");
+        }
+        BitSet_insert(&solution, n);
+        Scanner_skip_line(&s);
+    }
+
+    MappedFile_drop(&mf);
+    return solution;
+}
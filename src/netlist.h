@@ -3,43 +3,150 @@
 
 #include "vec.h"
 #include "bit_set.h"
+#include "mapped_file.h"
 
 /// Netlist related functions
 
+/// Type of the indices stored in segments, segment locations and graph edges.
+/// Building with `COMPACT_INDICES` defined makes them 32 bits wide,
+/// which halves the size of these structures;
+/// the loaders then reject the netlists whose indices do not fit.
+#ifdef COMPACT_INDICES
+typedef uint32_t index_t;
+#else
+typedef size_t index_t;
+#endif
+
+/// Can `n` be stored in an `index_t` ?
+bool index_fits(uint64_t n);
+
 typedef Vec PointVec;
 typedef struct {
     int32_t x;
     int32_t y;
 } Point, Vector;
+VEC_DEF(Point)
 
 typedef Vec SegmentVec;
 typedef struct {
-    size_t beg;
-    size_t end;
+    index_t beg;
+    index_t end;
 } Segment;
+VEC_DEF(Segment)
 
 typedef Vec NetVec;
 typedef struct {
     PointVec points;
     SegmentVec segments;
 } Net;
+VEC_DEF(Net)
 
 typedef struct {
     Point inf;
     Point sup;
 } AABB;
 
+/// How the nets and segments of a renumbered netlist map to the ones of its file.
+/// Every vector is empty when the netlist follows the file numbering.
+typedef struct {
+    /// `net_ids[n]` is the file number of the n-th net,
+    /// `net_ranks` is the inverse permutation.
+    Vec net_ids;
+    Vec net_ranks;
+    /// Renumbered netlists are flat: `segment_ids[f + s]` is the file number
+    /// of the s-th segment of the net whose segments start at `f`,
+    /// `segment_ranks` is the inverse permutation within every net.
+    Vec segment_ids;
+    Vec segment_ranks;
+} NetlistNumbering;
+
+/// Marks the points of the file which are dropped by the normalization.
+#define MERGED_POINT ((index_t)-1)
+
+/// How the points and segments of a normalized netlist map to the ones of its file,
+/// see `Netlist_normalized`. Every vector is empty when the netlist is not normalized.
+typedef struct {
+    /// The file points and segments of the n-th net are found in the vectors below
+    /// from `point_offsets[n]` and `segment_offsets[n]`, both have one more entry
+    /// holding the totals.
+    Vec point_offsets;
+    Vec segment_offsets;
+    /// The index of every file point in its normalized net, `MERGED_POINT`
+    /// if it was inside a merged segment.
+    Vec points;
+    /// The index of every file segment in its normalized net.
+    Vec segments;
+    /// The coordinates covered by the s-th file segment along its normalized segment
+    /// are `extents[2*s]..extents[2*s + 1]`: y for the vertical ones, x otherwise.
+    Vec extents;
+} NetlistMerges;
+
 typedef struct {
     NetVec nets;
     AABB aabb;
+    /// When the netlist is loaded from a binary file, the points and
+    /// segments of the nets are borrowed from this read-only mapping.
+    MappedFile mapping;
+    /// When the netlist is flat, the points and segments of the nets are
+    /// borrowed from these two arrays, where the nets follow each other.
+    PointVec points;
+    SegmentVec segments;
+    NetlistNumbering numbering;
+    NetlistMerges merges;
 } Netlist;
 
 /// Loads a netlist from a file.
+/// Binary and compressed netlists are detected by their magic number.
 Netlist Netlist_from_file(const char* path);
 
+/// Loads a netlist from a file by mapping it in memory
+/// and scanning the integers directly out of the mapped bytes.
+/// Produces the same netlist as `Netlist_from_file`.
+Netlist Netlist_from_mapped_file(const char* path);
+
+/// Loads a netlist like `Netlist_from_mapped_file`, allocating the text nets with `a`.
+/// Binary and compressed netlists ignore `a`.
+Netlist Netlist_from_mapped_file_in(const char* path, Allocator* a);
+
+/// Loads a netlist from a file using one thread per processor.
+/// The net boundaries are found first, then ranges of nets are parsed,
+/// checked and bounded concurrently.
+/// Produces the same netlist as `Netlist_from_file`.
+Netlist Netlist_from_file_parallel(const char* path);
+
+/// Loads a netlist from a file like `Netlist_from_mapped_file`, in the flat layout:
+/// all the points are stored in one array and all the segments in another,
+/// instead of two allocations per net.
+/// Binary netlists are flat as well, since they are mapped.
+Netlist Netlist_from_file_flat(const char* path);
+
+/// Returns a copy of the netlist in the flat layout.
+Netlist Netlist_to_flat(const Netlist* nl);
+
+/// Returns a copy of the netlist in the flat layout, renumbered so that
+/// the nets and segments which are close in the plane are close in memory:
+/// the nets are sorted along a Hilbert curve by the centre of their bounding box,
+/// and the segments of every net by their middle. The points keep their numbers.
+/// The file numbering is kept in `numbering`.
+Netlist Netlist_to_hilbert_order(const Netlist* nl);
+
+/// Returns a copy of the netlist in the flat layout with fewer points and segments:
+/// the points of a net with the same coordinates are welded into the first one,
+/// then the collinear segments of a net meeting end to end at a point
+/// which no other segment uses are merged, and that point is dropped.
+/// The nets keep their numbers, the file points and segments are mapped in `merges`.
+/// The intersections of the copy are the ones of the netlist, see
+/// `Netlist_intersections_to_file_numbering`.
+/// The solutions may not be: the dropped points are no more possible vias,
+/// a merged segment lies on a single layer, and the solvers can need more vias.
+Netlist Netlist_normalized(const Netlist* nl);
+
 /// Releases the netlist resources.
 void Netlist_drop(Netlist* nl);
 
+/// Saves the netlist to a text file.
+void Netlist_to_file(const Netlist* nl, const char* path);
+
 /// Prints the file representation of the netlist on the terminal.
 void Netlist_print(const Netlist* nl);
 
@@ -47,8 +154,8 @@ void Netlist_print(const Netlist* nl);
 size_t Netlist_segment_count(const Netlist* nl);
 
 typedef struct {
-    size_t net;
-    size_t seg;
+    index_t net;
+    index_t seg;
 } SegmentLoc;
 
 typedef Vec IntersectionVec;
@@ -57,12 +164,38 @@ typedef struct {
     SegmentLoc b;
     Point point;
 } Intersection;
+VEC_DEF(Intersection)
+
+/// A segment with its coordinates copied inline, so that the intersection
+/// engines do not have to go through the nets to reach its points.
+/// The coordinates are ordered: `x0 <= x1` and `y0 <= y1`.
+typedef struct {
+    int32_t x0;
+    int32_t y0;
+    int32_t x1;
+    int32_t y1;
+    SegmentLoc loc;
+    bool vertical;
+} ResolvedSegment;
+VEC_DEF(ResolvedSegment)
+
+typedef Vec SegmentTable;
+
+/// Resolves every segment of the netlist, net after net.
+SegmentTable SegmentTable_new(const Netlist* nl);
 
 /// Finds the netlist intersections by comparing the segments of different nets two by two.
+/// Every vertical segment is tested against all the horizontal ones at once with a `CrossingSet`.
 IntersectionVec Netlist_intersections_naive(const Netlist* nl);
 
+/// Finds the netlist intersections like `Netlist_intersections_naive`, with one thread
+/// per processor: the pairs of segments of the nets `i < j` are cut in many chunks holding
+/// about as many pairs, handed out to the threads as they get free.
+/// The intersections are the same, in another order.
+IntersectionVec Netlist_intersections_parallel_naive(const Netlist* nl);
+
 /// Finds the netlist intersections by sweeping over the different breakpoints of the x axis.
-/// This version uses a vector to manage current horizontal segments.
+/// This version uses a `CrossingSet` to manage current horizontal segments.
 IntersectionVec Netlist_intersections_vec_sweep(const Netlist* nl);
 
 /// Finds the netlist intersections by sweeping over the different breakpoints of the x axis.
@@ -73,14 +206,100 @@ IntersectionVec Netlist_intersections_list_sweep(const Netlist* nl);
 /// This version uses an AVL tree to manage current horizontal segments.
 IntersectionVec Netlist_intersections_avl_sweep(const Netlist* nl);
 
+/// Finds the intersections like `Netlist_intersections_avl_sweep`, taking the sweep state,
+/// the tree nodes and the returned intersections from `a`.
+IntersectionVec Netlist_intersections_avl_sweep_in(const Netlist* nl, Allocator* a);
+
+/// Finds the intersections like `Netlist_intersections_avl_sweep`, popping the breakpoints
+/// one at a time from a binary heap instead of sorting them at once.
+/// Only kept to measure the difference.
+IntersectionVec Netlist_intersections_avl_heap_sweep(const Netlist* nl);
+
+/// At most this many grid cells per segment, see `Netlist_intersections_grid`.
+#define GRID_CELLS_PER_SEGMENT 2
+
+/// Finds the netlist intersections by copying the segments in every cell they touch
+/// of a uniform grid over the netlist bounding box, then comparing the horizontal
+/// and vertical segments of every cell. A crossing is only reported by the cell
+/// holding its point. The cells are about as wide as the mean horizontal segment
+/// and as high as the mean vertical one, and are enlarged when there would be
+/// more than `GRID_CELLS_PER_SEGMENT` cells per segment.
+IntersectionVec Netlist_intersections_grid(const Netlist* nl);
+
+/// Finds the intersections like `Netlist_intersections_avl_sweep` with one thread
+/// per processor: once sorted, the breakpoints are cut in strips of the x axis
+/// holding about as many of them, which are swept concurrently, every strip starting
+/// with the horizontal segments crossing its left edge.
+/// The intersections are the same, in another order.
+IntersectionVec Netlist_intersections_parallel_sweep(const Netlist* nl);
+
+/// Finds the intersections of a netlist file like `Netlist_intersections_avl_sweep`,
+/// without building the netlist: the sweep breakpoints are pushed while parsing,
+/// only the points of the current net are kept.
+/// Binary and compressed netlists are detected by their magic number.
+IntersectionVec Netlist_file_intersections_avl_sweep(const char* path);
+
+/// Finds the intersections between the nets of `a` translated by `a_offset`
+/// and the nets of `b` translated by `b_offset`, like `Netlist_intersections_avl_sweep`
+/// but ignoring the intersections inside `a` and inside `b`.
+/// Only the segments touching `region` are swept, it should contain
+/// the overlap of the two netlists.
+/// The `a` locations refer to `a` and the `b` locations to `b`,
+/// the points are translated.
+IntersectionVec Netlist_intersections_between(const Netlist* a, Vector a_offset,
+                                              const Netlist* b, Vector b_offset,
+                                              AABB region);
+
+typedef enum {
+    BINARY_INTERSECTIONS,
+    TEXT_INTERSECTIONS
+} IntersectionFormat;
+
+/*
+ * ABOUT THE INTERSECTION FILES:
+ *
+ * The text format has one `a_net a_seg b_net b_seg` line per intersection,
+ * it is mostly useful for debugging.
+ * The binary format is a header followed by fixed-width records,
+ * every field being little-endian:
+ *   magic     8 bytes, "VIAINTB" followed by '\0'
+ *   version   u32
+ *   reserved  u32
+ *   count     u64
+ *   records   count x (u32 a_net, u32 a_seg, u32 b_net, u32 b_seg)
+ */
+
+/// Returns the location in the file numbering of the segment found at `loc`.
+/// A merged segment is given as the first file segment it comes from.
+SegmentLoc Netlist_file_loc(const Netlist* nl, SegmentLoc loc);
+
+/// Returns the location of the segment found at `loc` in the file numbering.
+SegmentLoc Netlist_loc_from_file(const Netlist* nl, SegmentLoc loc);
+
+/// Rewrites the intersections found in the netlist with the file numbering,
+/// so that they can be saved or compared with the netlist file.
+/// The intersection of two merged segments becomes one intersection
+/// per pair of file segments touching its point.
+void Netlist_intersections_to_file_numbering(const Netlist* nl, IntersectionVec* ints);
+
 /// Saves the netlist intersections to a file.
-void Netlist_intersections_to_file(IntersectionVec* ints, const char* path);
+void Netlist_intersections_to_file(IntersectionVec* ints, const char* path,
+                                   IntersectionFormat format);
+
+/// Loads the intersections of the netlist from a file,
+/// computing their points again.
+/// A normalized netlist gets one intersection per file intersection,
+/// the ones found along the same merged segments repeat.
+/// The intersection file format is detected by its magic number,
+/// its locations follow the file numbering.
+IntersectionVec Netlist_intersections_from_file(const Netlist* nl, const char* path);
 
 typedef Vec GraphEdgeVec;
 typedef struct {
-    size_t u;
-    size_t v;
+    index_t u;
+    index_t v;
 } GraphEdge;
+VEC_DEF(GraphEdge)
 
 typedef enum {
     POINT_NODE,
@@ -90,19 +309,43 @@ typedef enum {
 typedef Vec GraphNodeVec;
 typedef struct {
     GraphNodeType type;
+    /// Index of the first node of the node's net.
+    index_t net_offset;
     union {
         const Point* point;
         const Segment* segment;
     };
-    GraphEdgeVec continuity;
-    GraphEdgeVec conflict;
 } GraphNode;
+VEC_DEF(GraphNode)
+
+/// Neighbours of the graph nodes in compressed sparse row form:
+/// the neighbours of the n-th node are `targets[offsets[n]..offsets[n + 1]]`.
+typedef struct {
+    Vec offsets;
+    Vec targets;
+} GraphAdjacency;
 
 typedef struct {
     GraphNodeVec nodes;
+    /// Only the point nodes have their continuity neighbours stored,
+    /// the ones of a segment node are its ends, see `Graph_continuity`.
+    GraphAdjacency continuity;
+    GraphAdjacency conflict;
     Vec net_offsets;
+    /// When the nodes are relabelled, the i-th node is the `order[i]`-th one
+    /// of the layout described below and `rank` is the inverse permutation.
+    /// Both are empty otherwise.
+    Vec order;
+    Vec rank;
 } Graph;
 
+/// Continuity neighbours of a node, `nodes` may point to `ends`.
+typedef struct {
+    const index_t* nodes;
+    size_t count;
+    index_t ends[2];
+} GraphContinuity;
+
 /*
  * ABOUT THE GRAPH:
  *
@@ -116,11 +359,36 @@ typedef struct {
  */
 
 /// Creates the graph associated to the netlist and its intersections.
+/// The intersection file format is detected by its magic number,
+/// its locations follow the file numbering.
+/// The conflicts of a normalized netlist repeat like its intersections.
+/// The segment ends have to be points of their net, as the loaders check,
+/// the program stops otherwise.
 Graph Graph_new(const Netlist* nl, const char* int_path);
 
+/// Creates the graph like `Graph_new`, allocating its nodes and adjacencies with `a`.
+Graph Graph_new_in(const Netlist* nl, const char* int_path, Allocator* a);
+
+/// Returns a copy of the graph whose nodes are relabelled in reverse Cuthill-McKee order:
+/// breadth first from a node of lowest degree in every connected component,
+/// visiting the neighbours by increasing degree, then reversed.
+/// Neighbouring nodes get close indices, so that the solvers walking the graph
+/// find them close in memory. `g` must follow the layout described above.
+Graph Graph_relabelled(const Graph* g);
+
 /// Releases the graph resources.
 void Graph_drop(Graph* g);
 
+/// Returns the number of neighbours of the n-th node.
+size_t GraphAdjacency_degree(const GraphAdjacency* adj, size_t n);
+
+/// Returns the neighbours of the n-th node,
+/// there are `GraphAdjacency_degree(adj, n)` of them.
+const index_t* GraphAdjacency_neighbours(const GraphAdjacency* adj, size_t n);
+
+/// Finds the continuity neighbours of the n-th node.
+void Graph_continuity(const Graph* g, size_t n, GraphContinuity* c);
+
 /*
  * ABOUT THE SOLUTION:
  *
@@ -133,6 +401,7 @@ void Graph_drop(Graph* g);
 
 /// Solves the problem by putting every horizontal segments on a face
 ///                           and -----  vertical  ----------- the other.
+/// The graph must follow the layout, it cannot be relabelled.
 BitSet Graph_hv_solve(const Graph* g, const Netlist* nl);
 
 /// Solves the problem by finding odd cycles.
@@ -141,4 +410,21 @@ BitSet Graph_odd_cycle_solve(const Graph* g);
 /// Returns the number of vias required by the solution.
 size_t Solution_via_count(const BitSet* solution, const Graph* g);
 
+/// Returns the solution of a relabelled graph with the nodes numbered
+/// as in the layout of the graph, see `Graph_relabelled`.
+BitSet Solution_to_layout(const BitSet* solution, const Graph* g);
+
+/*
+ * ABOUT THE SOLUTION FILES:
+ *
+ * The first line is the number of nodes of the graph,
+ * followed by one line per node index contained in the solution.
+ */
+
+/// Saves the solution to a file.
+void Solution_to_file(const BitSet* solution, const Graph* g, const char* path);
+
+/// Loads a solution of the graph from a file.
+BitSet Solution_from_file(const Graph* g, const char* path);
+
 #endif // CIRCUIT_H
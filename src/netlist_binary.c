@@ -0,0 +1,210 @@
+#include "netlist_binary.h"
+
+static
+const char magic[NETLIST_BINARY_MAGIC_LEN] = "VIANETB";
+
+typedef struct {
+    char magic[NETLIST_BINARY_MAGIC_LEN];
+    uint32_t version;
+    uint32_t index_size;
+    uint64_t net_count;
+    uint64_t point_count;
+    uint64_t segment_count;
+    int32_t aabb[4];
+} Header;
+
+_Static_assert(sizeof(Header) % 8 == 0, "sections have to stay 8 bytes aligned");
+
+#define FORMAT_ERROR(desc) {                            \
+    perror("binary netlist format error: "desc"\n");    \
+    exit(1);                                            \
+}
+
+static
+bool host_is_little_endian(void);
+static
+void write_all(FILE* f, const void* data, size_t size);
+static
+void check_net(const Net* net, const AABB* aabb);
+
+bool is_binary_netlist(const char* data, size_t len) {
+    return len >= NETLIST_BINARY_MAGIC_LEN &&
+           memcmp(data, magic, NETLIST_BINARY_MAGIC_LEN) == 0;
+}
+
+bool host_is_little_endian() {
+    uint16_t one = 1;
+    uint8_t low;
+    memcpy(&low, &one, 1);
+    return low == 1;
+}
+
+Netlist Netlist_from_binary_file(const char* path) {
+    if (!host_is_little_endian()) {
+        FORMAT_ERROR("binary netlists can only be mapped on little-endian hosts");
+    }
+
+    MappedFile mf = MappedFile_open(path);
+    if (mf.len < sizeof(Header) || !is_binary_netlist(mf.data, mf.len)) {
+        FORMAT_ERROR("expected binary netlist header");
+    }
+
+    Header h;
+    memcpy(&h, mf.data, sizeof(Header));
+    if (h.version != NETLIST_BINARY_VERSION) {
+        FORMAT_ERROR("unsupported version");
+    }
+    if (h.index_size != sizeof(index_t)) {
+        FORMAT_ERROR("unsupported index size");
+    }
+    if (!index_fits(h.net_count)) {
+        FORMAT_ERROR("too many nets for the index size");
+    }
+
+    // Every section fits in the file on its own, so the sizes below cannot wrap around.
+    if (h.net_count >= mf.len / (2*sizeof(uint64_t)) ||
+        h.point_count > mf.len / sizeof(Point) ||
+        h.segment_count > mf.len / sizeof(Segment)) {
+        FORMAT_ERROR("unexpected file size");
+    }
+
+    size_t offsets_len = (h.net_count + 1)*sizeof(uint64_t);
+    size_t expected_len = sizeof(Header) + 2*offsets_len +
+                          h.point_count*sizeof(Point) +
+                          h.segment_count*sizeof(Segment);
+    if (mf.len != expected_len) {
+        FORMAT_ERROR("unexpected file size");
+    }
+
+    // Mappings are page aligned and every section is 8 bytes aligned.
+    const uint64_t* point_offsets = (const uint64_t*)(mf.data + sizeof(Header));
+    const uint64_t* segment_offsets = point_offsets + (h.net_count + 1);
+    Point* points = (Point*)(segment_offsets + (h.net_count + 1));
+    Segment* segments = (Segment*)(points + h.point_count);
+
+    AABB aabb = {
+        .inf = { h.aabb[0], h.aabb[1] },
+        .sup = { h.aabb[2], h.aabb[3] }
+    };
+
+    Vec nets = Vec_with_capacity(h.net_count, sizeof(Net));
+    for (size_t n = 0; n < h.net_count; n++) {
+        uint64_t p_beg = point_offsets[n], p_end = point_offsets[n + 1];
+        uint64_t s_beg = segment_offsets[n], s_end = segment_offsets[n + 1];
+        if (p_beg > p_end || p_end > h.point_count ||
+            s_beg > s_end || s_end > h.segment_count) {
+            FORMAT_ERROR("net offsets out of bounds");
+        }
+        if (!index_fits(s_end - s_beg)) {
+            FORMAT_ERROR("too many segments for the index size");
+        }
+
+        // Borrowed vectors, they are never grown nor freed.
+        Net net = {
+            .points = {
+                .data = points + p_beg, .elem_size = sizeof(Point),
+                .len = p_end - p_beg, .cap = p_end - p_beg
+            },
+            .segments = {
+                .data = segments + s_beg, .elem_size = sizeof(Segment),
+                .len = s_end - s_beg, .cap = s_end - s_beg
+            }
+        };
+        check_net(&net, &aabb);
+        Vec_push(&nets, &net);
+    }
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = aabb,
+        .mapping = mf
+    };
+}
+
+void check_net(const Net* net, const AABB* aabb) {
+    // The mapping is read only: the segments cannot be reordered like
+    // `check_net_segments` does, they have to be stored ordered already.
+    PointConstSpan points = PointVec_span(&net->points);
+    for (size_t p = 0; p < points.len; p++) {
+        Point pt = points.data[p];
+        if (pt.x < aabb->inf.x || aabb->sup.x < pt.x ||
+            pt.y < aabb->inf.y || aabb->sup.y < pt.y) {
+            FORMAT_ERROR("point outside of the header aabb");
+        }
+    }
+
+    SegmentConstSpan segments = SegmentVec_span(&net->segments);
+    for (size_t i = 0; i < segments.len; i++) {
+        const Segment* s = &segments.data[i];
+        if (s->beg >= points.len || s->end >= points.len) {
+            FORMAT_ERROR("segment point index out of bounds");
+        }
+        Point beg = points.data[s->beg];
+        Point end = points.data[s->end];
+        if (beg.x != end.x && beg.y != end.y) {
+            FORMAT_ERROR("segment neither horizontal nor vertical");
+        }
+        if (end.x < beg.x || end.y < beg.y) {
+            FORMAT_ERROR("segment points out of order");
+        }
+    }
+}
+
+void Netlist_to_binary_file(const Netlist* nl, const char* path) {
+    if (!host_is_little_endian()) {
+        FORMAT_ERROR("binary netlists can only be written on little-endian hosts");
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        perror("cannot open binary netlist output file");
+        exit(1);
+    }
+
+    size_t net_count = Vec_len(&nl->nets);
+    Vec point_offsets = Vec_with_capacity(net_count + 1, sizeof(uint64_t));
+    Vec segment_offsets = Vec_with_capacity(net_count + 1, sizeof(uint64_t));
+    uint64_t point_count = 0, segment_count = 0;
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        Vec_push(&point_offsets, &point_count);
+        Vec_push(&segment_offsets, &segment_count);
+        point_count += Vec_len(&net->points);
+        segment_count += Vec_len(&net->segments);
+    }
+    Vec_push(&point_offsets, &point_count);
+    Vec_push(&segment_offsets, &segment_count);
+
+    Header h = {
+        .version = NETLIST_BINARY_VERSION,
+        .index_size = sizeof(index_t),
+        .net_count = net_count,
+        .point_count = point_count,
+        .segment_count = segment_count,
+        .aabb = { nl->aabb.inf.x, nl->aabb.inf.y, nl->aabb.sup.x, nl->aabb.sup.y }
+    };
+    memcpy(h.magic, magic, NETLIST_BINARY_MAGIC_LEN);
+
+    write_all(f, &h, sizeof(Header));
+    write_all(f, point_offsets.data, (net_count + 1)*sizeof(uint64_t));
+    write_all(f, segment_offsets.data, (net_count + 1)*sizeof(uint64_t));
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        write_all(f, net->points.data, Vec_len(&net->points)*sizeof(Point));
+    }
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        write_all(f, net->segments.data, Vec_len(&net->segments)*sizeof(Segment));
+    }
+
+    Vec_drop(&segment_offsets);
+    Vec_drop(&point_offsets);
+    fclose(f);
+}
+
+void write_all(FILE* f, const void* data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, f) != size) {
+        perror("cannot write binary netlist");
+        exit(1);
+    }
+}
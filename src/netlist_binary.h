@@ -0,0 +1,46 @@
+#ifndef NETLIST_BINARY_H
+#define NETLIST_BINARY_H
+
+#include "netlist.h"
+
+/// Binary netlist files.
+
+/*
+ * ABOUT THE FORMAT:
+ *
+ * Every field is little-endian and every section is 8 bytes aligned.
+ *
+ *   magic           8 bytes, "VIANETB" followed by '\0'
+ *   version         u32
+ *   index_size      u32, size of a segment point index (4 with `COMPACT_INDICES`, else 8)
+ *   net_count       u64
+ *   point_count     u64
+ *   segment_count   u64
+ *   aabb            4 x i32, inf.x inf.y sup.x sup.y
+ *   point_offsets   (net_count + 1) x u64
+ *   segment_offsets (net_count + 1) x u64
+ *   points          point_count x (i32 x, i32 y)
+ *   segments        segment_count x (index beg, index end)
+ *
+ * The points of the n-th net are `points[point_offsets[n]..point_offsets[n + 1]]`
+ * and likewise for the segments. Segment indices are relative to their net,
+ * and already ordered as `check_net_segments` does it.
+ * Hence the arrays are laid out exactly as in memory and loading a file
+ * only needs to map it.
+ */
+
+#define NETLIST_BINARY_MAGIC_LEN 8
+#define NETLIST_BINARY_VERSION 1
+
+/// Do the `len` bytes starting at `data` begin with the binary netlist magic number ?
+bool is_binary_netlist(const char* data, size_t len);
+
+/// Loads a binary netlist by mapping the file.
+/// The nets borrow their points and segments from the mapping,
+/// so they must not be modified.
+Netlist Netlist_from_binary_file(const char* path);
+
+/// Saves the netlist to a binary file.
+void Netlist_to_binary_file(const Netlist* nl, const char* path);
+
+#endif // NETLIST_BINARY_H
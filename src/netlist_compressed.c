@@ -0,0 +1,334 @@
+#include "netlist_compressed.h"
+#include "parallel.h"
+#include "writer.h"
+
+static
+const char magic[NETLIST_COMPRESSED_MAGIC_LEN] = "VIANETZ";
+
+/// magic, version, reserved, 3 counts and the aabb.
+#define HEADER_LEN (NETLIST_COMPRESSED_MAGIC_LEN + 2*4 + 3*8 + 4*4)
+
+#define FORMAT_ERROR(desc) {                                \
+    perror("compressed netlist format error: "desc"\n");    \
+    exit(1);                                                \
+}
+
+typedef struct {
+    const uint8_t* pos;
+    const uint8_t* end;
+} Cursor;
+
+typedef struct {
+    Vec* nets;
+    const Vec* blocks;
+    /// The header aabb, its lower corner is the origin of the coordinate deltas.
+    AABB aabb;
+    size_t chunk_count;
+} CompressedLoad;
+
+static
+uint64_t get_le(Cursor* c, size_t size);
+static
+bool get_varint(Cursor* c, uint64_t* v);
+static
+Net decode_net(Cursor block, AABB aabb);
+/// Adds a zigzag encoded delta to `coordinate`, which has to stay an `int32_t`.
+static
+bool decode_coordinate(Cursor* c, int64_t* coordinate);
+static
+void decode_net_chunk(CompressedLoad* load, size_t c);
+static
+void put_le(Writer* w, uint64_t v, size_t size);
+static
+void put_varint(Writer* w, uint64_t v);
+static
+uint64_t zigzag(int64_t v);
+static
+void encode_net(Writer* w, const Net* net, Point origin);
+
+bool is_compressed_netlist(const char* data, size_t len) {
+    return len >= NETLIST_COMPRESSED_MAGIC_LEN &&
+           memcmp(data, magic, NETLIST_COMPRESSED_MAGIC_LEN) == 0;
+}
+
+uint64_t get_le(Cursor* c, size_t size) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < size; i++) {
+        v |= (uint64_t)c->pos[i] << (8*i);
+    }
+    c->pos += size;
+    return v;
+}
+
+bool get_varint(Cursor* c, uint64_t* v) {
+    // Most values fit in a byte.
+    if (c->pos < c->end && *c->pos < 0x80) {
+        *v = *c->pos++;
+        return true;
+    }
+
+    uint64_t r = 0;
+    for (unsigned shift = 0; shift < 64 && c->pos < c->end; shift += 7) {
+        uint8_t byte = *c->pos++;
+        r |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            *v = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+Netlist Netlist_from_compressed_file(const char* path) {
+    MappedFile mf = MappedFile_open(path);
+    if (mf.len < HEADER_LEN || !is_compressed_netlist(mf.data, mf.len)) {
+        FORMAT_ERROR("expected compressed netlist header");
+    }
+
+    Cursor c = {
+        .pos = (const uint8_t*)mf.data + NETLIST_COMPRESSED_MAGIC_LEN,
+        .end = (const uint8_t*)mf.data + mf.len
+    };
+    if (get_le(&c, 4) != NETLIST_COMPRESSED_VERSION) {
+        FORMAT_ERROR("unsupported version");
+    }
+    get_le(&c, 4);
+    uint64_t net_count = get_le(&c, 8);
+    uint64_t point_count = get_le(&c, 8);
+    uint64_t segment_count = get_le(&c, 8);
+    int32_t aabb[4];
+    for (size_t i = 0; i < 4; i++) {
+        aabb[i] = (int32_t)(uint32_t)get_le(&c, 4);
+    }
+
+    // Every block takes at least 3 bytes.
+    if (net_count > (size_t)(c.end - c.pos)/3 || !index_fits(net_count)) {
+        FORMAT_ERROR("unexpected net count");
+    }
+
+    // Only the block boundaries are read here, the workers decode the blocks.
+    Vec blocks = Vec_with_capacity(net_count, sizeof(Cursor));
+    for (size_t n = 0; n < net_count; n++) {
+        uint64_t block_len;
+        if (!get_varint(&c, &block_len) || block_len > (size_t)(c.end - c.pos)) {
+            FORMAT_ERROR("net block out of bounds");
+        }
+        Cursor block = { .pos = c.pos, .end = c.pos + block_len };
+        Vec_push(&blocks, &block);
+        c.pos = block.end;
+    }
+    if (c.pos != c.end) {
+        FORMAT_ERROR("unexpected data after the last net");
+    }
+
+    Vec nets = Vec_with_capacity(net_count, sizeof(Net));
+    Net empty = { .points = Vec_new(sizeof(Point)), .segments = Vec_new(sizeof(Segment)) };
+    for (size_t n = 0; n < net_count; n++) {
+        Vec_push(&nets, &empty);
+    }
+
+    // A few chunks per thread keep the threads busy when nets differ in size.
+    size_t thread_count = cpu_count();
+    size_t chunk_count = 4*thread_count;
+    if (chunk_count > net_count) chunk_count = net_count;
+
+    CompressedLoad load = {
+        .nets = &nets,
+        .blocks = &blocks,
+        .aabb = {
+            .inf = { aabb[0], aabb[1] },
+            .sup = { aabb[2], aabb[3] }
+        },
+        .chunk_count = chunk_count
+    };
+    parallel_for(chunk_count, thread_count,
+                 (void (*)(void*, size_t))decode_net_chunk, &load);
+
+    uint64_t decoded_points = 0, decoded_segments = 0;
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nets, n);
+        decoded_points += Vec_len(&net->points);
+        decoded_segments += Vec_len(&net->segments);
+    }
+    if (decoded_points != point_count || decoded_segments != segment_count) {
+        FORMAT_ERROR("unexpected point or segment count");
+    }
+
+    Vec_drop(&blocks);
+    MappedFile_drop(&mf);
+
+    return (Netlist) {
+        .nets = nets,
+        .aabb = {
+            .inf = { aabb[0], aabb[1] },
+            .sup = { aabb[2], aabb[3] }
+        }
+    };
+}
+
+void decode_net_chunk(CompressedLoad* load, size_t c) {
+    size_t net_count = Vec_len(load->nets);
+    size_t first = net_count*c/load->chunk_count;
+    size_t last = net_count*(c + 1)/load->chunk_count;
+
+    for (size_t n = first; n < last; n++) {
+        const Cursor* block = Vec_get(load->blocks, n);
+        *(Net*)Vec_get_mut(load->nets, n) = decode_net(*block, load->aabb);
+    }
+}
+
+Net decode_net(Cursor block, AABB aabb) {
+    uint64_t point_count, segment_count;
+    if (!get_varint(&block, &point_count) || !get_varint(&block, &segment_count)) {
+        FORMAT_ERROR("expected net point and segment counts");
+    }
+    // Points and segments take at least 2 bytes each.
+    size_t remaining = (size_t)(block.end - block.pos);
+    if (point_count > remaining/2 || segment_count > remaining/2 - point_count) {
+        FORMAT_ERROR("net counts do not fit in the block");
+    }
+    if (!index_fits(point_count) || !index_fits(segment_count)) {
+        FORMAT_ERROR("net counts do not fit the index size");
+    }
+
+    Net net = {
+        .points = Vec_with_capacity(point_count, sizeof(Point)),
+        .segments = Vec_with_capacity(segment_count, sizeof(Segment))
+    };
+
+    int64_t x = aabb.inf.x, y = aabb.inf.y;
+    for (size_t i = 0; i < point_count; i++) {
+        if (!decode_coordinate(&block, &x) || !decode_coordinate(&block, &y)) {
+            FORMAT_ERROR("expected point coordinates");
+        }
+        Point p = { .x = (int32_t)x, .y = (int32_t)y };
+        if (p.x < aabb.inf.x || aabb.sup.x < p.x || p.y < aabb.inf.y || aabb.sup.y < p.y) {
+            FORMAT_ERROR("point outside of the header aabb");
+        }
+        Vec_push(&net.points, &p);
+    }
+
+    for (size_t i = 0; i < segment_count; i++) {
+        uint64_t beg, end;
+        if (!get_varint(&block, &beg) || !get_varint(&block, &end) ||
+            beg >= point_count || end >= point_count) {
+            FORMAT_ERROR("expected segment point indices");
+        }
+        // Same checks as the text loaders, which also order the segment points.
+        const Point* b = Vec_get(&net.points, (size_t)beg);
+        const Point* e = Vec_get(&net.points, (size_t)end);
+        if (b->x != e->x && b->y != e->y) {
+            FORMAT_ERROR("segment neither horizontal nor vertical");
+        }
+        if (e->x < b->x || e->y < b->y) {
+            mem_swap(&beg, &end, sizeof(uint64_t));
+        }
+        Segment s = { .beg = (index_t)beg, .end = (index_t)end };
+        Vec_push(&net.segments, &s);
+    }
+
+    if (block.pos != block.end) {
+        FORMAT_ERROR("unexpected net block length");
+    }
+
+    return net;
+}
+
+bool decode_coordinate(Cursor* c, int64_t* coordinate) {
+    uint64_t v;
+    if (!get_varint(c, &v) || v > UINT32_MAX*UINT64_C(2) + 1) {
+        return false;
+    }
+    int64_t delta = (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    *coordinate += delta;
+    return INT32_MIN <= *coordinate && *coordinate <= INT32_MAX;
+}
+
+void Netlist_to_compressed_file(const Netlist* nl, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        perror("cannot open compressed netlist output file");
+        exit(1);
+    }
+    Writer w = Writer_new(f);
+
+    size_t net_count = Vec_len(&nl->nets);
+    uint64_t point_count = 0, segment_count = 0;
+    for (size_t n = 0; n < net_count; n++) {
+        const Net* net = Vec_get(&nl->nets, n);
+        point_count += Vec_len(&net->points);
+        segment_count += Vec_len(&net->segments);
+    }
+
+    Writer_put_bytes(&w, magic, NETLIST_COMPRESSED_MAGIC_LEN);
+    put_le(&w, NETLIST_COMPRESSED_VERSION, 4);
+    put_le(&w, 0, 4);
+    put_le(&w, net_count, 8);
+    put_le(&w, point_count, 8);
+    put_le(&w, segment_count, 8);
+    put_le(&w, (uint32_t)nl->aabb.inf.x, 4);
+    put_le(&w, (uint32_t)nl->aabb.inf.y, 4);
+    put_le(&w, (uint32_t)nl->aabb.sup.x, 4);
+    put_le(&w, (uint32_t)nl->aabb.sup.y, 4);
+
+    // Blocks are encoded first to know their length.
+    Writer block = Writer_new(NULL);
+    for (size_t n = 0; n < net_count; n++) {
+        block.len = 0;
+        encode_net(&block, Vec_get(&nl->nets, n), nl->aabb.inf);
+        put_varint(&w, block.len);
+        Writer_put_bytes(&w, block.buf, block.len);
+    }
+    Writer_drop(&block);
+
+    Writer_drop(&w);
+    if (ferror(f)) {
+        perror("cannot write compressed netlist");
+        exit(1);
+    }
+    fclose(f);
+}
+
+void encode_net(Writer* w, const Net* net, Point origin) {
+    size_t point_count = Vec_len(&net->points);
+    size_t segment_count = Vec_len(&net->segments);
+    put_varint(w, point_count);
+    put_varint(w, segment_count);
+
+    Point prev = origin;
+    for (size_t i = 0; i < point_count; i++) {
+        const Point* p = Vec_get(&net->points, i);
+        put_varint(w, zigzag((int64_t)p->x - prev.x));
+        put_varint(w, zigzag((int64_t)p->y - prev.y));
+        prev = *p;
+    }
+
+    for (size_t i = 0; i < segment_count; i++) {
+        const Segment* s = Vec_get(&net->segments, i);
+        put_varint(w, s->beg);
+        put_varint(w, s->end);
+    }
+}
+
+void put_le(Writer* w, uint64_t v, size_t size) {
+    char bytes[8];
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = (char)(uint8_t)(v >> (8*i));
+    }
+    Writer_put_bytes(w, bytes, size);
+}
+
+void put_varint(Writer* w, uint64_t v) {
+    char bytes[10];
+    size_t len = 0;
+    while (v >= 0x80) {
+        bytes[len++] = (char)(uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    bytes[len++] = (char)(uint8_t)v;
+    Writer_put_bytes(w, bytes, len);
+}
+
+uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (v < 0 ? UINT64_MAX : 0);
+}
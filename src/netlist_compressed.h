@@ -0,0 +1,48 @@
+#ifndef NETLIST_COMPRESSED_H
+#define NETLIST_COMPRESSED_H
+
+#include "netlist.h"
+
+/// Compressed netlist files, meant for archival.
+
+/*
+ * ABOUT THE FORMAT:
+ *
+ * A header, every field being little-endian:
+ *   magic           8 bytes, "VIANETZ" followed by '\0'
+ *   version         u32
+ *   reserved        u32
+ *   net_count       u64
+ *   point_count     u64
+ *   segment_count   u64
+ *   aabb            4 x i32, inf.x inf.y sup.x sup.y
+ * followed by one block per net:
+ *   block_len       varint, number of bytes of the block after this field
+ *   point_count     varint
+ *   segment_count   varint
+ *   points          point_count x (zigzag varint dx, zigzag varint dy)
+ *   segments        segment_count x (varint beg, varint end)
+ *
+ * Varints are LEB128: 7 bits per byte, low bits first, the high bit being
+ * set on every byte but the last. Zigzag maps 0, -1, 1, -2 ... to 0, 1, 2, 3 ...
+ * The first point of a net is relative to `aabb.inf` and every other point
+ * to the previous one, so that the small steps of the routed nets take one
+ * or two bytes. Segment indices are relative to their net and already
+ * ordered as `check_net_segments` does it.
+ * Thanks to `block_len`, the nets can be found without decoding them
+ * and then be decoded independently.
+ */
+
+#define NETLIST_COMPRESSED_MAGIC_LEN 8
+#define NETLIST_COMPRESSED_VERSION 1
+
+/// Do the `len` bytes starting at `data` begin with the compressed netlist magic number ?
+bool is_compressed_netlist(const char* data, size_t len);
+
+/// Loads a compressed netlist, decoding the nets with one thread per processor.
+Netlist Netlist_from_compressed_file(const char* path);
+
+/// Saves the netlist to a compressed file.
+void Netlist_to_compressed_file(const Netlist* nl, const char* path);
+
+#endif // NETLIST_COMPRESSED_H
@@ -0,0 +1,74 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "parallel.h"
+
+typedef struct {
+    atomic_size_t next;
+    size_t task_count;
+    void (*task)(void*, size_t);
+    void* ctx;
+} Work;
+
+static
+void* work_loop(void* w);
+
+size_t cpu_count() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (size_t)n : 1;
+}
+
+void parallel_for(size_t task_count, size_t thread_count,
+                  void (*task)(void*, size_t), void* ctx) {
+    if (thread_count == 0) {
+        thread_count = cpu_count();
+    }
+    thread_count = size_t_min(thread_count, task_count);
+
+    Work work = {
+        .task_count = task_count,
+        .task = task,
+        .ctx = ctx
+    };
+    atomic_init(&work.next, 0);
+
+    // The calling thread works too.
+    size_t spawned = (thread_count > 1) ? (thread_count - 1) : 0;
+    // A single thread spawns nothing, and `malloc(0)` may return `NULL`.
+    pthread_t* threads = NULL;
+    if (spawned > 0) {
+        threads = malloc(spawned*sizeof(pthread_t));
+        assert_alloc(threads);
+    }
+
+    for (size_t t = 0; t < spawned; t++) {
+        if (pthread_create(&threads[t], NULL, work_loop, &work)) {
+            perror("cannot create new thread");
+            exit(1);
+        }
+    }
+
+    work_loop(&work);
+
+    for (size_t t = 0; t < spawned; t++) {
+        if (pthread_join(threads[t], NULL) != 0) {
+            perror("cannot join thread");
+            exit(1);
+        }
+    }
+
+    free(threads);
+}
+
+void* work_loop(void* w) {
+    Work* work = w;
+    LOOP {
+        size_t i = atomic_fetch_add(&work->next, 1);
+        if (i >= work->task_count) break;
+        work->task(work->ctx, i);
+    }
+    return NULL;
+}
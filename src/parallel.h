@@ -0,0 +1,19 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "core.h"
+
+/// Data parallelism helpers.
+
+/// Returns the number of processors currently online (at least 1).
+size_t cpu_count(void);
+
+/// Calls `task(ctx, i)` for every `i` in `[0, task_count)`.
+/// Tasks are handed out in increasing order to up to `thread_count` threads,
+/// the calling thread being one of them.
+/// A `thread_count` of `0` means one thread per processor.
+/// Returns once every task is done.
+void parallel_for(size_t task_count, size_t thread_count,
+                  void (*task)(void*, size_t), void* ctx);
+
+#endif // PARALLEL_H
@@ -0,0 +1,47 @@
+#include "radix_sort.h"
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+void radix_sort_u64(uint64_t* keys, size_t len, Allocator* a) {
+    if (len < 2) return;
+
+    // Every pass is counted at once, in a single read of the keys.
+    size_t counts[RADIX_PASSES][RADIX_SIZE] = {{0}};
+    for (size_t i = 0; i < len; i++) {
+        uint64_t k = keys[i];
+        for (size_t p = 0; p < RADIX_PASSES; p++) {
+            counts[p][(k >> (p*RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+        }
+    }
+
+    uint64_t* scratch = Allocator_alloc(a, len*sizeof(uint64_t));
+    uint64_t* src = keys;
+    uint64_t* dst = scratch;
+    for (size_t p = 0; p < RADIX_PASSES; p++) {
+        size_t shift = p*RADIX_BITS;
+        size_t* count = counts[p];
+        if (count[(src[0] >> shift) & (RADIX_SIZE - 1)] == len) continue;
+
+        size_t offset = 0;
+        for (size_t d = 0; d < RADIX_SIZE; d++) {
+            size_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < len; i++) {
+            uint64_t k = src[i];
+            dst[count[(k >> shift) & (RADIX_SIZE - 1)]++] = k;
+        }
+
+        uint64_t* t = src;
+        src = dst;
+        dst = t;
+    }
+
+    if (src != keys) {
+        memcpy(keys, src, len*sizeof(uint64_t));
+    }
+    Allocator_free(a, scratch, len*sizeof(uint64_t));
+}
@@ -0,0 +1,13 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include "core.h"
+
+/// Sorting of integer keys without comparisons.
+
+/// Sorts `len` keys in increasing order, least significant byte first.
+/// The passes on a byte shared by all the keys are skipped.
+/// The scratch buffer, as large as the keys, is allocated with `a`.
+void radix_sort_u64(uint64_t* keys, size_t len, Allocator* a);
+
+#endif // RADIX_SORT_H
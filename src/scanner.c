@@ -0,0 +1,84 @@
+#include "scanner.h"
+
+static
+void skip_blanks(Scanner* s);
+static
+bool is_digit(char c);
+
+Scanner Scanner_new(const char* data, size_t len) {
+    return (Scanner) {
+        .pos = data,
+        .end = data + len
+    };
+}
+
+bool Scanner_is_empty(const Scanner* s) {
+    return s->pos == s->end;
+}
+
+size_t Scanner_remaining(const Scanner* s) {
+    return (size_t)(s->end - s->pos);
+}
+
+void Scanner_skip_line(Scanner* s) {
+    const char* nl = memchr(s->pos, '\n', Scanner_remaining(s));
+    s->pos = nl ? (nl + 1) : s->end;
+}
+
+void skip_blanks(Scanner* s) {
+    const char* p = s->pos;
+    while (p < s->end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        p++;
+    }
+    s->pos = p;
+}
+
+bool is_digit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+bool Scanner_size(Scanner* s, size_t* n) {
+    skip_blanks(s);
+
+    const char* p = s->pos;
+    if (p == s->end || !is_digit(*p)) return false;
+
+    size_t v = 0;
+    do {
+        size_t d = (size_t)(*p - '0');
+        if (v > (SIZE_MAX - d) / 10) return false;
+        v = v*10 + d;
+        p++;
+    } while (p < s->end && is_digit(*p));
+
+    s->pos = p;
+    *n = v;
+    return true;
+}
+
+bool Scanner_int32(Scanner* s, int32_t* n) {
+    skip_blanks(s);
+
+    const char* p = s->pos;
+    bool negative = false;
+    if (p < s->end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    if (p == s->end || !is_digit(*p)) return false;
+
+    // Accumulating the magnitude on 64 bits is enough to detect overflows.
+    int64_t v = 0;
+    do {
+        v = v*10 + (*p - '0');
+        if (v > (int64_t)INT32_MAX + 1) return false;
+        p++;
+    } while (p < s->end && is_digit(*p));
+
+    if (negative) v = -v;
+    if (v > INT32_MAX) return false;
+
+    s->pos = p;
+    *n = (int32_t)v;
+    return true;
+}
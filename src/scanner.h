@@ -0,0 +1,34 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include "core.h"
+
+/// A line oriented scanner reading integers straight out of a text buffer.
+/// The buffer is never modified nor required to be `\0` terminated.
+
+typedef struct {
+    const char* pos;
+    const char* end;
+} Scanner;
+
+/// Creates a scanner over the `len` bytes starting at `data`.
+Scanner Scanner_new(const char* data, size_t len);
+
+/// Is there nothing left to scan ?
+bool Scanner_is_empty(const Scanner* s);
+
+/// Returns the number of bytes left to scan.
+size_t Scanner_remaining(const Scanner* s);
+
+/// Skips the rest of the current line, including the `\n`.
+void Scanner_skip_line(Scanner* s);
+
+/// Skips blanks and reads an unsigned integer on the current line.
+/// Returns `false` if there is none or if it overflows.
+bool Scanner_size(Scanner* s, size_t* n);
+
+/// Skips blanks and reads a signed integer on the current line.
+/// Returns `false` if there is none or if it overflows.
+bool Scanner_int32(Scanner* s, int32_t* n);
+
+#endif // SCANNER_H
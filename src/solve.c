@@ -1,44 +1,140 @@
 #include "util.h"
 #include "netlist.h"
 #include "display.h"
+#include "cache.h"
 
 /// Solves the given netlist.
 
 BitSet odd_cycle_solve_wrapper(const Graph* g, const Netlist* nl);
+BitSet relabelled_odd_cycle_solve_wrapper(const Graph* g, const Netlist* nl);
 
 BitSet odd_cycle_solve_wrapper(const Graph* g, const Netlist* nl) {
     (void) nl;
     return Graph_odd_cycle_solve(g);
 }
 
+BitSet relabelled_odd_cycle_solve_wrapper(const Graph* g, const Netlist* nl) {
+    (void) nl;
+    Graph relabelled = Graph_relabelled(g);
+    BitSet relabelled_solution = Graph_odd_cycle_solve(&relabelled);
+    BitSet solution = Solution_to_layout(&relabelled_solution, &relabelled);
+    BitSet_drop(&relabelled_solution);
+    Graph_drop(&relabelled);
+    return solution;
+}
+
+typedef struct {
+    const BitSet* solution;
+    const Graph* graph;
+} SolutionSave;
+
+void save_solution(const SolutionSave* save, const char* path);
+
+void save_solution(const SolutionSave* save, const char* path) {
+    Solution_to_file(save->solution, save->graph, path);
+}
+
 int main() {
     char file[255];
     ask_str("enter the netlist file name: ", file, 255);
     char* path = str_surround("netlists/", file, ".net");
 
+    char loader[20];
+    ask_str("choose a loader (stdio/mmap/parallel): ", loader, 20);
+
+    Netlist (*load)(const char*);
+    if (strcmp(loader, "stdio") == 0) {
+        load = Netlist_from_file;
+    } else if (strcmp(loader, "mmap") == 0) {
+        load = Netlist_from_mapped_file;
+    } else if (strcmp(loader, "parallel") == 0) {
+        load = Netlist_from_file_parallel;
+    } else {
+        perror("unknown loader");
+        exit(1);
+    }
+
     char method[20];
-    ask_str("choose a method (hv/odd_cycle): ", method, 20);
+    ask_str("choose a method (hv/odd_cycle/odd_cycle_rcm): ", method, 20);
 
     BitSet (*solve)(const Graph*, const Netlist*);
     if (strcmp(method, "hv") == 0) {
         solve = Graph_hv_solve;
     } else if (strcmp(method, "odd_cycle") == 0) {
         solve = odd_cycle_solve_wrapper;
+    } else if (strcmp(method, "odd_cycle_rcm") == 0) {
+        solve = relabelled_odd_cycle_solve_wrapper;
     } else {
         perror("unknown method");
         exit(1);
     }
 
+    char renumbered[20];
+    ask_str("renumber the nets along a Hilbert curve (yes/no): ", renumbered, 20);
+    bool use_hilbert_order = strcmp(renumbered, "yes") == 0;
+
+    char merged[20];
+    ask_str("merge the collinear segments and duplicate points (yes/no): ", merged, 20);
+    // Fewer nodes, but the merged points are no more possible vias:
+    // the solution may differ from the one of the file netlist.
+    bool use_normalized = strcmp(merged, "yes") == 0;
+    if (use_hilbert_order && use_normalized) {
+        // Each copy only maps its own nodes back to the file.
+        perror("cannot both renumber and normalize the netlist");
+        exit(1);
+    }
+
+    char cached[20];
+    ask_str("use the cache (yes/no): ", cached, 20);
+    bool use_cache = strcmp(cached, "yes") == 0;
+
     char* intersection_path = change_extension(path, "int");
     char* graph_display_path = change_extension(path, "graph.ps");
     char* solution_display_path = change_extension(path, "sol.ps");
 
     printf("handling `%s` ... ", path);
 
-    Netlist netlist = Netlist_from_file(path);
+    Netlist netlist = load(path);
+    if (use_hilbert_order) {
+        Netlist ordered = Netlist_to_hilbert_order(&netlist);
+        Netlist_drop(&netlist);
+        netlist = ordered;
+    } else if (use_normalized) {
+        Netlist normal = Netlist_normalized(&netlist);
+        Netlist_drop(&netlist);
+        netlist = normal;
+    }
     Graph graph = Graph_new(&netlist, intersection_path);
     Graph_to_ps(&graph, &netlist, graph_display_path);
-    BitSet solution = solve(&graph, &netlist);
+    BitSet solution;
+    if (use_cache) {
+        Cache cache = Cache_open(CACHE_DEFAULT_DIR, CACHE_DEFAULT_MAX_SIZE);
+        CacheKey key = CacheKey_add_file(CacheKey_new(), path);
+        key = CacheKey_add_file(key, intersection_path);
+        key = CacheKey_add_str(key, method);
+        if (use_hilbert_order) {
+            // The solution nodes follow the netlist numbering.
+            key = CacheKey_add_str(key, "hilbert");
+        } else if (use_normalized) {
+            key = CacheKey_add_str(key, "normalized");
+        }
+
+        char* entry = Cache_get(&cache, key, "sol");
+        if (entry) {
+            solution = Solution_from_file(&graph, entry);
+            free(entry);
+        } else {
+            solution = solve(&graph, &netlist);
+            SolutionSave save = { .solution = &solution, .graph = &graph };
+            Cache_put(&cache, key, "sol",
+                      (void (*)(const void*, const char*))save_solution, &save);
+        }
+
+        Cache_print_stats(&cache);
+        Cache_drop(&cache);
+    } else {
+        solution = solve(&graph, &netlist);
+    }
     Solution_to_ps(&solution, &graph, &netlist, solution_display_path);
 
     BitSet_drop(&solution);
@@ -0,0 +1,326 @@
+#include <stdatomic.h>
+
+#include "tokenizer.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_TOKENIZERS
+#include <immintrin.h>
+#endif
+
+typedef struct {
+    int64_t* values;
+    size_t max;
+    size_t count;
+    bool malformed;
+} Tokens;
+
+/// A vectorized block is only read when this many bytes are left,
+/// so that eight digits can always be loaded from within a block.
+#define SIMD_SLACK 64
+
+/// Longer integers may not fit 64 bits.
+#define MAX_DIGITS 18
+
+static
+size_t scalar_line(Scanner* s, int64_t* values, size_t max);
+static
+void scalar_tail(Scanner* s, const char* p, Tokens* t);
+static
+void push_token(Tokens* t, int64_t v);
+static
+size_t tokens_result(const Tokens* t);
+static inline
+bool is_digit(char c);
+static inline
+bool is_blank(char c);
+static inline
+bool is_sign(const char* line, const char* p);
+static inline
+int64_t digits_to_int(const char* p, size_t len);
+static inline
+size_t block_tokens(const char* line, const char* p,
+                    uint32_t digits, uint32_t others, uint32_t newlines, size_t width,
+                    Tokens* t, bool* line_end);
+
+#ifdef X86_TOKENIZERS
+static
+size_t sse42_line(Scanner* s, int64_t* values, size_t max);
+static
+size_t avx2_line(Scanner* s, int64_t* values, size_t max);
+#endif
+
+typedef size_t (*LineReader)(Scanner*, int64_t*, size_t);
+
+static
+_Atomic LineReader selected_line = NULL;
+
+bool Tokenizer_is_supported(Tokenizer t) {
+    switch (t) {
+        case SCALAR_TOKENIZER:
+            return true;
+#ifdef X86_TOKENIZERS
+        case SSE42_TOKENIZER:
+            return __builtin_cpu_supports("sse4.2");
+        case AVX2_TOKENIZER:
+            return __builtin_cpu_supports("avx2");
+#else
+        case SSE42_TOKENIZER:
+        case AVX2_TOKENIZER:
+            return false;
+#endif
+    }
+    return false;
+}
+
+Tokenizer Tokenizer_best() {
+    if (Tokenizer_is_supported(AVX2_TOKENIZER)) return AVX2_TOKENIZER;
+    if (Tokenizer_is_supported(SSE42_TOKENIZER)) return SSE42_TOKENIZER;
+    return SCALAR_TOKENIZER;
+}
+
+const char* Tokenizer_name(Tokenizer t) {
+    switch (t) {
+        case SCALAR_TOKENIZER: return "scalar";
+        case SSE42_TOKENIZER: return "sse4.2";
+        case AVX2_TOKENIZER: return "avx2";
+    }
+    return "unknown";
+}
+
+void Tokenizer_select(Tokenizer t) {
+    assert(Tokenizer_is_supported(t));
+    LineReader line = scalar_line;
+    switch (t) {
+        case SCALAR_TOKENIZER:
+            break;
+#ifdef X86_TOKENIZERS
+        case SSE42_TOKENIZER:
+            line = sse42_line;
+            break;
+        case AVX2_TOKENIZER:
+            line = avx2_line;
+            break;
+#else
+        case SSE42_TOKENIZER:
+        case AVX2_TOKENIZER:
+            break;
+#endif
+    }
+    atomic_store(&selected_line, line);
+}
+
+size_t Tokenizer_line(Scanner* s, int64_t* values, size_t max) {
+    LineReader line = atomic_load_explicit(&selected_line, memory_order_relaxed);
+    // Concurrent first calls all select the same reader.
+    if (!line) {
+        Tokenizer_select(Tokenizer_best());
+        line = atomic_load(&selected_line);
+    }
+    return line(s, values, max);
+}
+
+void push_token(Tokens* t, int64_t v) {
+    if (t->count < t->max) {
+        t->values[t->count] = v;
+    }
+    t->count++;
+}
+
+size_t tokens_result(const Tokens* t) {
+    return t->malformed ? TOKENIZER_MALFORMED : t->count;
+}
+
+bool is_digit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool is_sign(const char* line, const char* p) {
+    // The byte after `p` is always readable: a line never ends on the sign.
+    return (*p == '-' || *p == '+') && is_digit(p[1]) && (p == line || is_blank(p[-1]));
+}
+
+size_t scalar_line(Scanner* s, int64_t* values, size_t max) {
+    Tokens t = { .values = values, .max = max, .count = 0, .malformed = false };
+    scalar_tail(s, s->pos, &t);
+    return tokens_result(&t);
+}
+
+void scalar_tail(Scanner* s, const char* p, Tokens* t) {
+    const char* end = s->end;
+    while (p < end && *p != '\n') {
+        if (is_digit(*p)) {
+            const char* run = p;
+            while (p < end && is_digit(*p)) p++;
+
+            size_t len = (size_t)(p - run);
+            if (len > MAX_DIGITS) {
+                t->malformed = true;
+                continue;
+            }
+            int64_t v = 0;
+            for (size_t i = 0; i < len; i++) {
+                v = v*10 + (run[i] - '0');
+            }
+            bool negative = (run > s->pos) && (run[-1] == '-');
+            push_token(t, negative ? -v : v);
+        } else {
+            if (!is_blank(*p) && !(p + 1 < end && is_sign(s->pos, p))) {
+                t->malformed = true;
+            }
+            p++;
+        }
+    }
+    s->pos = (p < end) ? (p + 1) : end;
+}
+
+int64_t digits_to_int(const char* p, size_t len) {
+    // At most `MAX_DIGITS` digits, the caller checks it.
+    if (len > 8) {
+        return digits_to_int(p, len - 8)*100000000 + digits_to_int(p + len - 8, 8);
+    }
+
+    // Eight ASCII digits in a register, the first one in the low byte.
+    uint64_t v;
+    memcpy(&v, p, 8);
+    // Dropping the bytes after the run: the digits end up in the high
+    // bytes and the low ones are zero, which reads as leading zeros.
+    v <<= 8*(8 - len);
+    // Combining pairs of digits, then pairs of pairs, and so on.
+    v = (v & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+    v = (v & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+    return (int64_t)((v & 0x0000FFFF0000FFFF) * 42949672960001 >> 32);
+}
+
+size_t block_tokens(const char* line, const char* p,
+                    uint32_t digits, uint32_t others, uint32_t newlines, size_t width,
+                    Tokens* t, bool* line_end) {
+    uint64_t full = (width == 32) ? 0xFFFFFFFF : ((1ull << width) - 1);
+    uint64_t d = digits & full;
+
+    uint64_t o = others & full;
+    size_t consumed = width;
+
+    if (newlines) {
+        size_t nl = (size_t)__builtin_ctz(newlines);
+        d &= (1ull << nl) - 1;
+        o &= (1ull << nl) - 1;
+        consumed = nl + 1;
+        *line_end = true;
+    } else if (d >> (width - 1)) {
+        // A run reaches the end of the block, it is left for the next one.
+        uint64_t non_digits = ~d & full;
+        if (!non_digits) return 0;
+        size_t last = 63 - (size_t)__builtin_clzll(non_digits);
+        consumed = last + 1;
+        d &= (1ull << consumed) - 1;
+        o &= (1ull << consumed) - 1;
+    }
+
+    // The bytes which are neither digits nor blanks can only be signs.
+    while (o) {
+        size_t i = (size_t)__builtin_ctzll(o);
+        if (!is_sign(line, p + i)) {
+            t->malformed = true;
+        }
+        o &= o - 1;
+    }
+
+    while (d) {
+        size_t start = (size_t)__builtin_ctzll(d);
+        size_t len = (size_t)__builtin_ctzll(~(d >> start));
+        if (len > MAX_DIGITS) {
+            t->malformed = true;
+        } else {
+            int64_t v = digits_to_int(p + start, len);
+            bool negative = (p + start > line) && (p[start - 1] == '-');
+            push_token(t, negative ? -v : v);
+        }
+        d &= ~((1ull << (start + len)) - 1);
+    }
+
+    return consumed;
+}
+
+#ifdef X86_TOKENIZERS
+
+__attribute__((target("sse4.2")))
+size_t sse42_line(Scanner* s, int64_t* values, size_t max) {
+    Tokens t = { .values = values, .max = max, .count = 0, .malformed = false };
+    const char* line = s->pos;
+    const char* p = line;
+    const __m128i ranges = _mm_setr_epi8('0', '9', 0, 0, 0, 0, 0, 0,
+                                         0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+
+    while (s->end - p >= SIMD_SLACK) {
+        __m128i block = _mm_loadu_si128((const __m128i*)p);
+        __m128i digit_mask = _mm_cmpestrm(ranges, 2, block, 16,
+                                          _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                                          _SIDD_BIT_MASK);
+        uint32_t digits = (uint32_t)_mm_cvtsi128_si32(digit_mask);
+        uint32_t newlines = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        __m128i blanks = _mm_or_si128(_mm_cmpeq_epi8(block, space),
+                                      _mm_or_si128(_mm_cmpeq_epi8(block, tab),
+                                                   _mm_cmpeq_epi8(block, carriage_return)));
+        uint32_t others = ~(digits | newlines | (uint32_t)_mm_movemask_epi8(blanks));
+
+        bool line_end = false;
+        size_t consumed = block_tokens(line, p, digits, others, newlines, 16, &t, &line_end);
+        if (consumed == 0) break; // absurdly long number
+        p += consumed;
+        if (line_end) {
+            s->pos = p;
+            return tokens_result(&t);
+        }
+    }
+
+    scalar_tail(s, p, &t);
+    return tokens_result(&t);
+}
+
+__attribute__((target("avx2")))
+size_t avx2_line(Scanner* s, int64_t* values, size_t max) {
+    Tokens t = { .values = values, .max = max, .count = 0, .malformed = false };
+    const char* line = s->pos;
+    const char* p = line;
+    // Digits are the only bytes above '/' and below ':'.
+    const __m256i below_zero = _mm256_set1_epi8('0' - 1);
+    const __m256i above_nine = _mm256_set1_epi8('9' + 1);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i carriage_return = _mm256_set1_epi8('\r');
+
+    while (s->end - p >= SIMD_SLACK) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)p);
+        __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(block, below_zero),
+                                            _mm256_cmpgt_epi8(above_nine, block));
+        uint32_t digits = (uint32_t)_mm256_movemask_epi8(is_digit);
+        uint32_t newlines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline));
+        __m256i blanks = _mm256_or_si256(_mm256_cmpeq_epi8(block, space),
+                                         _mm256_or_si256(_mm256_cmpeq_epi8(block, tab),
+                                                         _mm256_cmpeq_epi8(block, carriage_return)));
+        uint32_t others = ~(digits | newlines | (uint32_t)_mm256_movemask_epi8(blanks));
+
+        bool line_end = false;
+        size_t consumed = block_tokens(line, p, digits, others, newlines, 32, &t, &line_end);
+        if (consumed == 0) break; // absurdly long number
+        p += consumed;
+        if (line_end) {
+            s->pos = p;
+            return tokens_result(&t);
+        }
+    }
+
+    scalar_tail(s, p, &t);
+    return tokens_result(&t);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include "scanner.h"
+
+/// A vectorized reader for lines of integers.
+/// Bytes are classified by blocks of 16 (SSE4.2) or 32 (AVX2) to find the
+/// digit runs and the line end at once, the runs are then converted eight
+/// digits at a time within a 64 bits register.
+/// The implementation is chosen at runtime, with a scalar fallback.
+
+typedef enum {
+    SCALAR_TOKENIZER,
+    SSE42_TOKENIZER,
+    AVX2_TOKENIZER
+} Tokenizer;
+
+/// Does the processor support the tokenizer ?
+bool Tokenizer_is_supported(Tokenizer t);
+
+/// Returns the fastest tokenizer supported by the processor.
+Tokenizer Tokenizer_best(void);
+
+/// Returns the name of the tokenizer.
+const char* Tokenizer_name(Tokenizer t);
+
+/// Forces the tokenizer used by `Tokenizer_line`.
+/// By default, the best one is used.
+void Tokenizer_select(Tokenizer t);
+
+/// Returned by `Tokenizer_line` for a malformed line.
+#define TOKENIZER_MALFORMED SIZE_MAX
+
+/// Reads the integers of the current line and moves past its end.
+/// The first `max` integers are stored in `values`.
+/// Integers are separated by blanks (spaces, tabs and carriage returns),
+/// a `-` or `+` between a blank and an integer gives its sign.
+/// Returns the number of integers found on the line, or `TOKENIZER_MALFORMED`
+/// if the line holds any other byte or an integer of more than 18 digits.
+size_t Tokenizer_line(Scanner* s, int64_t* values, size_t max);
+
+#endif // TOKENIZER_H
@@ -7,33 +7,42 @@ static
 void drop_elems(Vec* v, void (*drop_elem)(void*));
 
 Vec Vec_new(size_t elem_size) {
+    return Vec_new_in(elem_size, NULL);
+}
+
+Vec Vec_with_capacity(size_t capacity, size_t elem_size) {
+    return Vec_with_capacity_in(capacity, elem_size, NULL);
+}
+
+Vec Vec_new_in(size_t elem_size, Allocator* a) {
     return (Vec) {
         .data = NULL, .elem_size = elem_size,
-        .len = 0, .cap = 0
+        .len = 0, .cap = 0,
+        .allocator = a
     };
 }
 
-Vec Vec_with_capacity(size_t capacity, size_t elem_size) {
+Vec Vec_with_capacity_in(size_t capacity, size_t elem_size, Allocator* a) {
     if (capacity == 0) {
-        return Vec_new(elem_size);
+        return Vec_new_in(elem_size, a);
     }
 
-    void* data = malloc(capacity*elem_size);
-    assert_alloc(data);
+    void* data = Allocator_alloc(a, capacity*elem_size);
 
     return (Vec) {
         .data = data, .elem_size = elem_size,
-        .len = 0, .cap = capacity
+        .len = 0, .cap = capacity,
+        .allocator = a
     };
 }
 
 void Vec_drop(Vec* v) {
-    free(v->data);
+    Allocator_free(v->allocator, v->data, v->cap*v->elem_size);
 }
 
 void Vec_drop_with(Vec* v, void (*drop_elem)(void*)) {
     drop_elems(v, drop_elem);
-    free(v->data);
+    Allocator_free(v->allocator, v->data, v->cap*v->elem_size);
 }
 
 void drop_elems(Vec* v, void (*drop_elem)(void*)) {
@@ -90,8 +99,8 @@ void Vec_reserve(Vec* v, size_t needed) {
 void Vec_reserve_len(Vec* v, size_t len) {
     if (len > v->cap) {
         size_t new_cap = next_power_of_two(len);
-        v->data = realloc(v->data, v->elem_size*new_cap);
-        assert_alloc(v->data);
+        v->data = Allocator_realloc(v->allocator, v->data,
+                                    v->elem_size*v->cap, v->elem_size*new_cap);
         v->cap = new_cap;
     }
 }
@@ -13,6 +13,8 @@ typedef struct {
     size_t elem_size;
     size_t len;
     size_t cap;
+    /// Where the data is allocated, `NULL` for the heap.
+    Allocator* allocator;
 } Vec;
 
 /// Creates an empty vector that will contain elements of size `elem_size`.
@@ -22,6 +24,12 @@ Vec Vec_new(size_t elem_size);
 /// Creates an empty vector with the specified capacity.
 Vec Vec_with_capacity(size_t capacity, size_t elem_size);
 
+/// Creates an empty vector like `Vec_new`, allocating with `a`.
+Vec Vec_new_in(size_t elem_size, Allocator* a);
+
+/// Creates an empty vector like `Vec_with_capacity`, allocating with `a`.
+Vec Vec_with_capacity_in(size_t capacity, size_t elem_size, Allocator* a);
+
 /// Releases the vector resources.
 void Vec_drop(Vec* v);
 
@@ -82,4 +90,50 @@ void Vec_clear_with(Vec* v, void (*drop_elem)(void*));
 /// Index out of bounds results in an error.
 void Vec_swap_remove(Vec* v, size_t i, void* e);
 
+/// Defines typed accessors for the vectors of `T`, which the compiler can inline:
+/// `T##Span`, a raw view over the elements,
+/// `T##Vec_span` and `T##Vec_span_mut`, returning the view of a vector,
+/// `T##Vec_at` and `T##Vec_at_mut`, returning a pointer to the element of index `i`,
+/// `T##Vec_push`, pushing an element by value.
+/// The vector must contain elements of type `T`, nothing is checked:
+/// index out of bounds results in undefined behavior.
+#define VEC_DEF(T)                                                  \
+    typedef struct {                                                \
+        T* data;                                                    \
+        size_t len;                                                 \
+    } T##Span;                                                      \
+                                                                    \
+    typedef struct {                                                \
+        const T* data;                                              \
+        size_t len;                                                 \
+    } T##ConstSpan;                                                 \
+                                                                    \
+    static inline                                                   \
+    T##ConstSpan T##Vec_span(const Vec* v) {                        \
+        return (T##ConstSpan) { .data = v->data, .len = v->len };   \
+    }                                                               \
+                                                                    \
+    static inline                                                   \
+    T##Span T##Vec_span_mut(Vec* v) {                               \
+        return (T##Span) { .data = v->data, .len = v->len };        \
+    }                                                               \
+                                                                    \
+    static inline                                                   \
+    const T* T##Vec_at(const Vec* v, size_t i) {                    \
+        return (const T*)v->data + i;                               \
+    }                                                               \
+                                                                    \
+    static inline                                                   \
+    T* T##Vec_at_mut(Vec* v, size_t i) {                            \
+        return (T*)v->data + i;                                     \
+    }                                                               \
+                                                                    \
+    static inline                                                   \
+    void T##Vec_push(Vec* v, T e) {                                 \
+        if (v->len == v->cap) {                                     \
+            Vec_reserve(v, 1);                                      \
+        }                                                           \
+        ((T*)v->data)[v->len++] = e;                                \
+    }
+
 #endif // VEC_H
@@ -0,0 +1,168 @@
+#include "writer.h"
+#include "parallel.h"
+
+#define FILE_BUFFER_SIZE (1 << 20)
+#define MEMORY_BUFFER_SIZE (1 << 16)
+/// Number of items formatted by a task of `Writer_put_parallel`.
+#define PARALLEL_CHUNK_ITEMS (1 << 14)
+
+/// Decimal digit pairs, "00" to "99".
+static
+const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+typedef struct {
+    Writer* chunks;
+    size_t item_count;
+    void (*format)(Writer*, const void*, size_t);
+    const void* ctx;
+} ParallelFormat;
+
+static
+void reserve(Writer* w, size_t needed);
+static
+size_t format_u64(char* end, uint64_t n);
+static
+void format_chunk(ParallelFormat* pf, size_t c);
+
+Writer Writer_new(FILE* file) {
+    size_t cap = file ? FILE_BUFFER_SIZE : MEMORY_BUFFER_SIZE;
+    char* buf = malloc(cap);
+    assert_alloc(buf);
+
+    return (Writer) {
+        .file = file,
+        .buf = buf,
+        .len = 0,
+        .cap = cap
+    };
+}
+
+void Writer_drop(Writer* w) {
+    Writer_flush(w);
+    free(w->buf);
+}
+
+void Writer_flush(Writer* w) {
+    if (!w->file || w->len == 0) return;
+
+    if (fwrite(w->buf, 1, w->len, w->file) != w->len) {
+        perror("cannot write output file");
+        exit(1);
+    }
+    w->len = 0;
+}
+
+void reserve(Writer* w, size_t needed) {
+    if (w->len + needed <= w->cap) return;
+
+    if (w->file) {
+        Writer_flush(w);
+        if (needed <= w->cap) return;
+    }
+
+    size_t cap = checked_next_power_of_two(w->len + needed);
+    w->buf = realloc(w->buf, cap);
+    assert_alloc(w->buf);
+    w->cap = cap;
+}
+
+void Writer_put_bytes(Writer* w, const char* bytes, size_t len) {
+    reserve(w, len);
+    memcpy(w->buf + w->len, bytes, len);
+    w->len += len;
+}
+
+void Writer_put_char(Writer* w, char c) {
+    reserve(w, 1);
+    w->buf[w->len++] = c;
+}
+
+void Writer_put_str(Writer* w, const char* s) {
+    Writer_put_bytes(w, s, strlen(s));
+}
+
+size_t format_u64(char* end, uint64_t n) {
+    // Writing backwards from `end`, two digits at a time.
+    char* p = end;
+    while (n >= 100) {
+        const char* pair = &digit_pairs[(n % 100)*2];
+        n /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (n >= 10) {
+        const char* pair = &digit_pairs[n*2];
+        *--p = pair[1];
+        *--p = pair[0];
+    } else {
+        *--p = (char)('0' + n);
+    }
+    return (size_t)(end - p);
+}
+
+void Writer_put_size(Writer* w, size_t n) {
+    char digits[20];
+    size_t len = format_u64(digits + 20, n);
+    Writer_put_bytes(w, digits + 20 - len, len);
+}
+
+void Writer_put_int32(Writer* w, int32_t n) {
+    char digits[11];
+    // Going through 64 bits so that `-INT32_MIN` does not overflow.
+    int64_t v = n;
+    uint64_t magnitude = (uint64_t)((v < 0) ? -v : v);
+    size_t len = format_u64(digits + 11, magnitude);
+    if (v < 0) {
+        digits[11 - ++len] = '-';
+    }
+    Writer_put_bytes(w, digits + 11 - len, len);
+}
+
+void Writer_put_parallel(Writer* w, size_t item_count, size_t thread_count,
+                         void (*format)(Writer*, const void*, size_t),
+                         const void* ctx) {
+    size_t chunk_count = (item_count + PARALLEL_CHUNK_ITEMS - 1) / PARALLEL_CHUNK_ITEMS;
+    // Nothing to write, and `malloc(0)` may return `NULL`.
+    if (chunk_count == 0) {
+        return;
+    }
+    Writer* chunks = malloc(chunk_count*sizeof(Writer));
+    assert_alloc(chunks);
+
+    ParallelFormat pf = {
+        .chunks = chunks,
+        .item_count = item_count,
+        .format = format,
+        .ctx = ctx
+    };
+    parallel_for(chunk_count, thread_count,
+                 (void (*)(void*, size_t))format_chunk, &pf);
+
+    for (size_t c = 0; c < chunk_count; c++) {
+        Writer_put_bytes(w, chunks[c].buf, chunks[c].len);
+        Writer_drop(&chunks[c]);
+    }
+
+    free(chunks);
+}
+
+void format_chunk(ParallelFormat* pf, size_t c) {
+    Writer* chunk = &pf->chunks[c];
+    *chunk = Writer_new(NULL);
+
+    size_t beg = c*PARALLEL_CHUNK_ITEMS;
+    size_t end = size_t_min(beg + PARALLEL_CHUNK_ITEMS, pf->item_count);
+    for (size_t i = beg; i < end; i++) {
+        pf->format(chunk, pf->ctx, i);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include "core.h"
+
+/// A buffered text writer with its own integer formatting.
+
+typedef struct {
+    FILE* file;
+    char* buf;
+    size_t len;
+    size_t cap;
+} Writer;
+
+/// Creates a writer flushing to `file` by large blocks.
+/// If `file` is `NULL`, everything is kept in memory instead.
+Writer Writer_new(FILE* file);
+
+/// Flushes the writer and releases its resources.
+/// The file is not closed.
+void Writer_drop(Writer* w);
+
+/// Writes the buffered bytes to the file.
+/// Does nothing for in-memory writers.
+void Writer_flush(Writer* w);
+
+/// Appends `len` bytes.
+void Writer_put_bytes(Writer* w, const char* bytes, size_t len);
+
+/// Appends a character.
+void Writer_put_char(Writer* w, char c);
+
+/// Appends a string.
+void Writer_put_str(Writer* w, const char* s);
+
+/// Appends an unsigned integer, formatted as `%zu` would.
+void Writer_put_size(Writer* w, size_t n);
+
+/// Appends a signed integer, formatted as `%d` would.
+void Writer_put_int32(Writer* w, int32_t n);
+
+/// Appends `item_count` formatted items, in order.
+/// The items are formatted by chunks into in-memory writers by up to
+/// `thread_count` threads (`0` for one per processor), `format` being
+/// called as `format(chunk_writer, ctx, i)` for every item `i`.
+void Writer_put_parallel(Writer* w, size_t item_count, size_t thread_count,
+                         void (*format)(Writer*, const void*, size_t),
+                         const void* ctx);
+
+#endif // WRITER_H
@@ -0,0 +1,65 @@
+#include "../src/arena.h"
+#include "../src/vec.h"
+#include "../src/avl_tree.h"
+
+int8_t cmp(const int32_t* a, const int32_t* b);
+
+int8_t cmp(const int32_t* a, const int32_t* b) {
+    return (*a > *b) - (*a < *b);
+}
+
+int main() {
+    Arena arena = Arena_new(256, false);
+    Allocator* a = Arena_allocator(&arena);
+    assert(Arena_allocated(&arena) == 0);
+
+    // Blocks are aligned and the last one grows in place.
+    char* p = Allocator_alloc(a, 3);
+    char* q = Allocator_alloc(a, 5);
+    assert((uintptr_t)p % ARENA_ALIGN == 0);
+    assert((uintptr_t)q % ARENA_ALIGN == 0);
+    assert(Allocator_realloc(a, q, 5, 64) == q);
+    memcpy(p, "ab", 3);
+    char* moved = Allocator_realloc(a, p, 3, 6);
+    assert(moved != p);
+    assert(strcmp(moved, "ab") == 0);
+
+    // Blocks larger than the chunk size get their own chunk.
+    Allocator_alloc(a, 1024);
+    assert(Arena_allocated(&arena) > 1024);
+
+    #define N 1000
+    Vec v = Vec_new_in(sizeof(uint32_t), a);
+    for (uint32_t i = 0; i < N; i++) {
+        Vec_push(&v, &i);
+    }
+    for (uint32_t i = 0; i < N; i++) {
+        assert(*(const uint32_t*)Vec_get(&v, i) == i);
+    }
+    Vec_drop(&v);
+
+    AVLTree avl = AVLTree_new_in(sizeof(int32_t),
+                                 (int8_t (*)(const void*, const void*))cmp, a);
+    for (int32_t i = 0; i < N; i++) {
+        int32_t e = (i * 7) % N;
+        assert(AVLTree_insert(&avl, &e));
+    }
+    for (int32_t i = 0; i < N; i += 2) {
+        assert(AVLTree_remove(&avl, &i, NULL));
+    }
+    assert(!AVLTree_is_empty(&avl));
+    AVLTree_clear(&avl);
+
+    Arena_reset(&arena);
+    assert(Arena_allocated(&arena) > 0);
+    assert(Allocator_alloc(a, 8) != NULL);
+    Arena_drop(&arena);
+    assert(Arena_allocated(&arena) == 0);
+
+    Arena huge = Arena_new(4096, true);
+    assert(Allocator_alloc(Arena_allocator(&huge), 16) != NULL);
+    assert(Arena_allocated(&huge) == ARENA_HUGE_PAGE_SIZE);
+    Arena_drop(&huge);
+
+    return EXIT_SUCCESS;
+}
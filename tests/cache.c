@@ -0,0 +1,56 @@
+#include "../src/cache.h"
+
+#define DIR "build/cache_test"
+
+void save_bytes(const size_t* len, const char* path);
+
+void save_bytes(const size_t* len, const char* path) {
+    FILE* f = fopen(path, "wb");
+    assert(f);
+    for (size_t i = 0; i < *len; i++) {
+        fputc('x', f);
+    }
+    fclose(f);
+}
+
+int main() {
+    CacheKey k = CacheKey_new();
+    assert(CacheKey_add_str(CacheKey_add_str(k, "ab"), "c") ==
+           CacheKey_add_str(CacheKey_add_str(k, "ab"), "c"));
+    assert(CacheKey_add_str(CacheKey_add_str(k, "ab"), "c") !=
+           CacheKey_add_str(CacheKey_add_str(k, "a"), "bc"));
+
+    CacheKey k1 = CacheKey_add_str(k, "first");
+    CacheKey k2 = CacheKey_add_str(k, "second");
+    void (*save)(const void*, const char*) = (void (*)(const void*, const char*))save_bytes;
+    size_t len = 60;
+
+    // A cache that cannot hold anything, to start from an empty directory.
+    Cache c = Cache_open(DIR, 0);
+    Cache_put(&c, k1, "test", save, &len);
+    assert(!Cache_get(&c, k1, "test"));
+    Cache_drop(&c);
+
+    c = Cache_open(DIR, 100);
+    assert(!Cache_get(&c, k1, "test"));
+    Cache_put(&c, k1, "test", save, &len);
+
+    char* path = Cache_get(&c, k1, "test");
+    assert(path);
+    FILE* f = fopen(path, "rb");
+    assert(f && fseek(f, 0, SEEK_END) == 0 && ftell(f) == 60);
+    fclose(f);
+    free(path);
+
+    // Only one entry fits, the least recently used one goes.
+    Cache_put(&c, k2, "test", save, &len);
+    assert(!Cache_get(&c, k1, "test"));
+    path = Cache_get(&c, k2, "test");
+    assert(path);
+    free(path);
+
+    assert(c.hits == 2 && c.misses == 2 && c.evictions == 1);
+    Cache_drop(&c);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#include <time.h>
+
+#include "../src/crossing.h"
+
+typedef struct {
+    int32_t y;
+    int32_t x0;
+    int32_t x1;
+    uint32_t net;
+} Horizontal;
+
+int cmp(const size_t* a, const size_t* b);
+
+int cmp(const size_t* a, const size_t* b) {
+    return (*a > *b) - (*a < *b);
+}
+
+int main() {
+    srand(time(NULL));
+
+    #define N 1000
+    Horizontal hs[N];
+    CrossingSet cs = CrossingSet_new();
+    for (size_t i = 0; i < N; i++) {
+        int32_t x = rand() % 200 - 100;
+        hs[i] = (Horizontal) {
+            .y = rand() % 200 - 100,
+            .x0 = x,
+            .x1 = x + rand() % 50,
+            .net = (uint32_t)rand() % 4
+        };
+        CrossingSet_push(&cs, hs[i].y, hs[i].x0, hs[i].x1, hs[i].net, i);
+    }
+    assert(CrossingSet_len(&cs) == N);
+
+    // Every segment not removed is found, whatever the block it is in.
+    for (size_t i = 0; i < N; i += 3) {
+        assert(CrossingSet_remove(&cs, i));
+    }
+    assert(!CrossingSet_remove(&cs, 0));
+
+    Vec found = Vec_new(sizeof(size_t));
+    for (size_t t = 0; t < 200; t++) {
+        int32_t x = rand() % 200 - 100;
+        int32_t y0 = rand() % 200 - 100;
+        int32_t y1 = y0 + rand() % 100;
+        uint32_t net = (uint32_t)rand() % 4;
+
+        Vec_clear(&found);
+        CrossingSet_find(&cs, x, y0, y1, net, &found);
+        qsort(found.data, Vec_len(&found), sizeof(size_t),
+              (int (*)(const void*, const void*))cmp);
+
+        size_t k = 0;
+        for (size_t i = 0; i < N; i++) {
+            const Horizontal* h = &hs[i];
+            if (i % 3 != 0 && h->net != net && h->x0 <= x && x <= h->x1 && y0 <= h->y && h->y <= y1) {
+                assert(k < Vec_len(&found));
+                assert(*(const size_t*)Vec_get(&found, k) == i);
+                k++;
+            }
+        }
+        assert(k == Vec_len(&found));
+    }
+
+    // The ends are included.
+    CrossingSet_drop(&cs);
+    cs = CrossingSet_new();
+    CrossingSet_push(&cs, 5, 0, 10, 1, 42);
+    Vec_clear(&found);
+    CrossingSet_find(&cs, 10, 5, 8, 0, &found);
+    CrossingSet_find(&cs, 0, 0, 5, 1, &found);
+    assert(Vec_len(&found) == 1 && *(const size_t*)Vec_get(&found, 0) == 42);
+
+    // Only the segments from `first` on are tested.
+    CrossingSet_push(&cs, 6, 0, 10, 1, 43);
+    Vec_clear(&found);
+    CrossingSet_find_from(&cs, 1, 5, 0, 10, 0, &found);
+    assert(Vec_len(&found) == 1 && *(const size_t*)Vec_get(&found, 0) == 43);
+
+    Vec_drop(&found);
+    CrossingSet_drop(&cs);
+    return EXIT_SUCCESS;
+}
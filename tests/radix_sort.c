@@ -0,0 +1,42 @@
+#include <time.h>
+
+#include "../src/radix_sort.h"
+
+int cmp(const uint64_t* a, const uint64_t* b);
+
+int cmp(const uint64_t* a, const uint64_t* b) {
+    return (*a > *b) - (*a < *b);
+}
+
+int main() {
+    srand(time(NULL));
+
+    #define N 1000
+    uint64_t keys[N];
+    uint64_t sorted[N];
+
+    for (size_t i = 0; i < N; i++) {
+        keys[i] = ((uint64_t)rand() << 40) ^ ((uint64_t)rand() << 16) ^ (uint64_t)rand();
+    }
+    memcpy(sorted, keys, sizeof(keys));
+    qsort(sorted, N, sizeof(uint64_t), (int (*)(const void*, const void*))cmp);
+    radix_sort_u64(keys, N, NULL);
+    assert(memcmp(keys, sorted, sizeof(keys)) == 0);
+
+    // Only the low byte differs, the other passes are skipped.
+    for (size_t i = 0; i < N; i++) {
+        keys[i] = ((uint64_t)0xabcd << 48) | (uint64_t)(N - i) % 256;
+    }
+    radix_sort_u64(keys, N, NULL);
+    for (size_t i = 1; i < N; i++) {
+        assert(keys[i - 1] <= keys[i]);
+    }
+    assert(keys[0] == (uint64_t)0xabcd << 48);
+
+    uint64_t single = 42;
+    radix_sort_u64(&single, 1, NULL);
+    assert(single == 42);
+    radix_sort_u64(NULL, 0, NULL);
+
+    return EXIT_SUCCESS;
+}
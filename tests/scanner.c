@@ -0,0 +1,29 @@
+#include "../src/scanner.h"
+
+int main() {
+    const char text[] = "12  -7\t+3\n  x 4\n2147483648 99999999999999999999999\n";
+    Scanner s = Scanner_new(text, sizeof(text) - 1);
+
+    size_t n = 0;
+    int32_t i = 0;
+    assert(Scanner_size(&s, &n) && n == 12);
+    assert(!Scanner_size(&s, &n));
+    assert(Scanner_int32(&s, &i) && i == -7);
+    assert(Scanner_int32(&s, &i) && i == 3);
+    assert(!Scanner_int32(&s, &i)); // end of line
+
+    Scanner_skip_line(&s);
+    assert(!Scanner_size(&s, &n)); // `x` is not a number
+    Scanner_skip_line(&s);
+
+    assert(!Scanner_int32(&s, &i)); // overflow
+    assert(Scanner_size(&s, &n) && n == 2147483648u);
+    assert(!Scanner_size(&s, &n)); // overflow
+
+    Scanner_skip_line(&s);
+    assert(Scanner_is_empty(&s));
+    Scanner_skip_line(&s);
+    assert(Scanner_is_empty(&s));
+
+    return EXIT_SUCCESS;
+}
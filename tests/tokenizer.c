@@ -0,0 +1,89 @@
+#include "../src/tokenizer.h"
+
+/// Every tokenizer has to agree with the scalar one,
+/// whatever the alignment of the numbers in the vectorized blocks.
+
+#define MAX_VALUES 64
+
+void tokenize_all(Tokenizer t, const char* text, size_t len,
+                  int64_t* values, size_t* counts, size_t* line_count);
+
+void tokenize_all(Tokenizer t, const char* text, size_t len,
+                  int64_t* values, size_t* counts, size_t* line_count) {
+    Tokenizer_select(t);
+    Scanner s = Scanner_new(text, len);
+    *line_count = 0;
+    while (!Scanner_is_empty(&s)) {
+        counts[*line_count] = Tokenizer_line(&s, &values[*line_count*MAX_VALUES],
+                                             MAX_VALUES);
+        (*line_count)++;
+    }
+}
+
+int main() {
+    const char text[] =
+        "0 8 7\n"
+        "  0 5296 1107\n"
+        "  12 -4080 +345\n"
+        "12345678 123456789 1234567890123 999999999999999999\n"
+        "1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25\n"
+        "\n"
+        "    7\t-0 +1\r\n"
+        "    7 x42y\n"
+        "1.5\n"
+        "12-3 4\n"
+        "- 4\n"
+        "5 99999999999999999999999\n"
+        "1234567890123456789012345678901234567890\n"
+        "3 3";
+
+    #define MAX_LINES 16
+    #define LINE_COUNT 14
+    int64_t expected[MAX_LINES*MAX_VALUES];
+    size_t expected_counts[MAX_LINES];
+    size_t expected_lines;
+
+    // Shifting the text around moves the numbers across the blocks.
+    for (size_t shift = 0; shift < 40; shift++) {
+        char buffer[sizeof(text) + 40];
+        memset(buffer, ' ', shift);
+        memcpy(buffer + shift, text, sizeof(text) - 1);
+        size_t len = shift + sizeof(text) - 1;
+
+        tokenize_all(SCALAR_TOKENIZER, buffer, len,
+                     expected, expected_counts, &expected_lines);
+        assert(expected_lines == LINE_COUNT);
+        assert(expected_counts[0] == 3 && expected[2] == 7);
+        assert(expected_counts[2] == 3 && expected[2*MAX_VALUES + 1] == -4080);
+        assert(expected[2*MAX_VALUES + 2] == 345);
+        assert(expected[3*MAX_VALUES + 3] == 999999999999999999);
+        assert(expected_counts[4] == 25 && expected[4*MAX_VALUES + 24] == 25);
+        assert(expected_counts[5] == 0);
+        assert(expected_counts[6] == 3 && expected[6*MAX_VALUES + 1] == 0);
+        assert(expected[6*MAX_VALUES + 2] == 1);
+        for (size_t l = 7; l < LINE_COUNT - 1; l++) {
+            assert(expected_counts[l] == TOKENIZER_MALFORMED);
+        }
+        assert(expected_counts[LINE_COUNT - 1] == 2);
+
+        for (Tokenizer t = SSE42_TOKENIZER; t <= AVX2_TOKENIZER; t++) {
+            if (!Tokenizer_is_supported(t)) continue;
+
+            int64_t values[MAX_LINES*MAX_VALUES];
+            size_t counts[MAX_LINES];
+            size_t lines;
+            tokenize_all(t, buffer, len, values, counts, &lines);
+
+            assert(lines == expected_lines);
+            for (size_t l = 0; l < lines; l++) {
+                assert(counts[l] == expected_counts[l]);
+                if (counts[l] == TOKENIZER_MALFORMED) continue;
+                for (size_t v = 0; v < counts[l]; v++) {
+                    assert(values[l*MAX_VALUES + v] == expected[l*MAX_VALUES + v]);
+                }
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
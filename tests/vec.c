@@ -1,5 +1,7 @@
 #include "../src/vec.h"
 
+VEC_DEF(uint32_t)
+
 int main() {
     Vec v = Vec_new(sizeof(uint32_t));
     assert(Vec_is_empty(&v));
@@ -20,5 +22,20 @@ int main() {
     assert(Vec_pop(&v, NULL) == false);
     Vec_drop(&v);
 
+    Vec t = Vec_new(sizeof(uint32_t));
+    for (uint32_t i = 0; i < N; i++) {
+        uint32_tVec_push(&t, i);
+        assert(*uint32_tVec_at(&t, i) == i);
+    }
+    uint32_tSpan span = uint32_tVec_span_mut(&t);
+    assert(span.len == N);
+    for (size_t i = 0; i < span.len; i++) {
+        span.data[i] *= 2;
+    }
+    for (uint32_t i = 0; i < N; i++) {
+        assert(*(const uint32_t*)Vec_get(&t, i) == 2*i);
+    }
+    Vec_drop(&t);
+
     return EXIT_SUCCESS;
 }
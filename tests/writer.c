@@ -0,0 +1,60 @@
+#include "../src/writer.h"
+
+void format_item(Writer* w, const void* ctx, size_t i);
+
+void format_item(Writer* w, const void* ctx, size_t i) {
+    (void) ctx;
+    Writer_put_size(w, i*i);
+    Writer_put_char(w, ' ');
+    Writer_put_int32(w, -(int32_t)i);
+    Writer_put_char(w, '\n');
+}
+
+int main() {
+    Writer w = Writer_new(NULL);
+
+    size_t sizes[] = { 0, 7, 10, 99, 100, 12345, 4294967296u, SIZE_MAX };
+    int32_t ints[] = { 0, -1, 9, -10, 2147483647, -2147483647 - 1 };
+    char expected[64];
+
+    for (size_t i = 0; i < sizeof(sizes)/sizeof(size_t); i++) {
+        w.len = 0;
+        Writer_put_size(&w, sizes[i]);
+        int len = snprintf(expected, 64, "%zu", sizes[i]);
+        assert(w.len == (size_t)len && memcmp(w.buf, expected, w.len) == 0);
+    }
+
+    for (size_t i = 0; i < sizeof(ints)/sizeof(int32_t); i++) {
+        w.len = 0;
+        Writer_put_int32(&w, ints[i]);
+        int len = snprintf(expected, 64, "%d", ints[i]);
+        assert(w.len == (size_t)len && memcmp(w.buf, expected, w.len) == 0);
+    }
+
+    // Parallel formatting has to keep the items in order.
+    #define N 100000
+    Writer serial = Writer_new(NULL);
+    for (size_t i = 0; i < N; i++) {
+        format_item(&serial, NULL, i);
+    }
+
+    FILE* f = tmpfile();
+    assert(f);
+    Writer parallel = Writer_new(f);
+    Writer_put_parallel(&parallel, N, 4, format_item, NULL);
+    Writer_drop(&parallel);
+
+    assert((size_t)ftell(f) == serial.len);
+    rewind(f);
+    char* written = malloc(serial.len);
+    size_t read_len = fread(written, 1, serial.len, f);
+    assert(read_len == serial.len);
+    assert(memcmp(written, serial.buf, serial.len) == 0);
+
+    free(written);
+    fclose(f);
+    Writer_drop(&serial);
+    Writer_drop(&w);
+
+    return EXIT_SUCCESS;
+}